@@ -23,6 +23,7 @@ struct wlr_session;
 #include <wlr/render/wlr_texture.h>
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_cursor.h>
+#include <wlr/types/wlr_damage_ring.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_input_device.h>
 #include <wlr/types/wlr_keyboard.h>
@@ -39,6 +40,7 @@ struct wlr_session;
 #endif
 #include <wlr/types/wlr_xcursor_manager.h>
 #include <wlr/types/wlr_xdg_shell.h>
+#include <wlr/types/wlr_xdg_activation_v1.h>
 #include <wlr/types/wlr_xdg_decoration_v1.h>
 #include <wlr/util/log.h>
 #include <wlr/util/box.h>
@@ -54,15 +56,19 @@ struct wlr_session;
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <functional>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #endif
 
@@ -163,9 +169,14 @@ struct LauncherEntry {
 struct ForestUIState {
     std::vector<PanelApp> panel_apps;
     std::vector<TrayIndicator> tray_icons;
+    std::vector<LauncherEntry> builtin_entries;  // Always listed ahead of installed applications
     std::vector<LauncherEntry> launcher_entries;
+    std::string launcher_query;              // Typed while the launcher is open, lowercased
+    std::vector<uint32_t> launcher_matches;  // Indices into launcher_entries, best match first
     bool launcher_visible{false};
-    std::size_t highlighted_index{0};
+    std::size_t highlighted_index{0};        // Position in launcher_matches
+    float launcher_scroll{0.0f};             // Pixels scrolled, eases towards the target
+    float launcher_scroll_target{0.0f};
     std::chrono::steady_clock::time_point last_interaction{std::chrono::steady_clock::now()};
     SwissDesign::Color accent_color{SwissDesign::SWISS_RED};
     SwissDesign::Color panel_base{SwissDesign::WHITE};
@@ -200,6 +211,447 @@ struct ForestUIState {
     } volume_feedback;
 };
 
+// Output-local geometry of the panel and launcher. One layout pass per UI or
+// output change feeds both the Cairo drawing code and pointer hit-testing.
+enum class ChromeTarget : uint8_t {
+    NONE,
+    MENU,
+    PANEL_APP,
+    TRAY_ICON
+};
+
+struct ChromeHit {
+    ChromeTarget target{ChromeTarget::NONE};
+    int16_t index{-1};
+};
+
+struct ChromeRect {
+    double x{0.0};
+    double y{0.0};
+    double width{0.0};
+    double height{0.0};
+
+    bool contains(double px, double py) const {
+        return px >= x && py >= y && px < x + width && py < y + height;
+    }
+};
+
+struct LauncherGeometry {
+    ChromeRect panel;
+    double entry_x{0.0};
+    double entry_y{0.0};       // Top of the first entry
+    double entry_width{0.0};
+    double entry_height{0.0};  // Drawn card height
+    double entry_pitch{0.0};   // Distance between consecutive entries
+    double rows_height{0.0};   // Scrolling viewport below entry_y
+};
+
+// Launcher rows intersecting the viewport, [first, last)
+struct LauncherRowRange {
+    std::size_t first{0};
+    std::size_t last{0};
+};
+
+struct ChromeLayout {
+    ArolloaOutput *output{nullptr};
+    struct wlr_box layout_box{};          // Output extent in layout coordinates
+    std::size_t panel_app_count{0};
+    std::size_t tray_icon_count{0};
+    std::size_t launcher_entry_count{0};
+    std::vector<ChromeRect> panel_apps;   // Icon rectangles
+    std::vector<ChromeRect> tray_icons;
+    std::vector<ChromeHit> panel_columns; // Hover target per pixel column of the panel
+    LauncherGeometry launcher;
+};
+
+struct ChromeLayoutCache {
+    std::vector<ChromeLayout> outputs;
+    ArolloaOutput *pointer_output{nullptr}; // Output the pointer was last found on
+    bool stale{true};
+};
+
+// One XKB context and one compiled keymap per RMLVO set, shared by all
+// keyboards.
+struct KeymapCache {
+    struct xkb_context *context{nullptr};
+    std::unordered_map<std::string, struct xkb_keymap *> keymaps;
+};
+
+// Keyboard shortcuts, loaded from bind.* config entries
+enum class BindingAction : uint8_t {
+    NONE,
+    SPAWN,
+    EXIT,
+    TOGGLE_LAUNCHER,
+    LAUNCHER_CLOSE,
+    LAUNCHER_NEXT,
+    LAUNCHER_PREV,
+    LAUNCHER_ACTIVATE,
+    LAUNCHER_ERASE,
+    FOCUS_NEXT,
+    MOVE,
+    LAYOUT,
+    CYCLE_LAYOUT,
+    TOGGLE_LOW_POWER,
+    WORKSPACE,
+    MOVE_TO_WORKSPACE,
+    TOGGLE_OVERVIEW,
+    SWITCHER_NEXT,
+    SWITCHER_PREV,
+    SWITCHER_CANCEL
+};
+
+enum class BindingMode : uint8_t {
+    DEFAULT,
+    LAUNCHER, // Active while the launcher is open; falls back to DEFAULT
+    SWITCHER, // Active while the window switcher is open; falls back to DEFAULT
+    COUNT
+};
+
+struct KeyBinding {
+    BindingAction action{BindingAction::NONE};
+    std::string argument;
+    bool repeats{false};
+};
+
+struct BindingTable {
+    // Keyed by (modifier mask << 32) | lower-case keysym
+    std::unordered_map<uint64_t, KeyBinding> press;
+    std::unordered_map<uint64_t, KeyBinding> release;
+};
+
+struct KeybindingEngine {
+    BindingTable modes[static_cast<std::size_t>(BindingMode::COUNT)];
+    std::vector<uint32_t> swallowed_keycodes; // Presses consumed by a binding
+    uint32_t last_pressed_keycode{0};         // Release bindings only fire on a tap
+    std::vector<xkb_keysym_t> scratch_syms;   // Candidate keysyms of the key being handled
+    struct wl_event_source *repeat_timer{nullptr};
+    KeyBinding repeat_binding;
+    uint32_t repeat_keycode{0};
+    int32_t repeat_rate{0};
+};
+
+// Input-to-present latency tracing, enabled with debug.latency_trace
+enum class LatencySource : uint8_t {
+    KEY,
+    POINTER_MOTION,
+    POINTER_BUTTON,
+    COUNT
+};
+
+constexpr std::size_t LATENCY_BUCKETS = 34; // 1 ms buckets, last one is overflow
+constexpr std::size_t LATENCY_TRACE_SIZE = 256;
+
+struct LatencySample {
+    LatencySource source{LatencySource::KEY};
+    uint32_t event_msec{0};    // Device timestamp from the input event
+    uint64_t received_ns{0};   // Monotonic time the compositor saw the event
+    uint64_t committed_ns{0};  // Output commit that first showed its effect
+    uint64_t presented_ns{0};  // Backend presentation timestamp, or the commit time if never shown
+    bool presented{false};
+};
+
+struct LatencyTracer {
+    struct PendingEvent {
+        LatencySample sample;
+        const struct wlr_surface *target{nullptr}; // Client expected to respond
+        uint64_t ui_generation{0};
+        bool ready{false};                         // Effect is waiting to be committed
+        ArolloaOutput *output{nullptr};            // Set once committed
+    };
+
+    bool enabled{false};
+    std::vector<PendingEvent> pending;
+    uint32_t histograms[static_cast<std::size_t>(LatencySource::COUNT)][LATENCY_BUCKETS]{};
+    std::vector<LatencySample> trace;              // Ring of recent completed samples
+    std::size_t trace_head{0};
+    uint64_t completed{0};
+    uint64_t expired{0};                           // Inputs with no visible effect
+    uint64_t unpresented{0};                       // Committed but never shown, kept out of the histograms
+    uint64_t reported{0};
+    std::string report_path;
+    struct wl_event_source *report_timer{nullptr};
+};
+
+// Launcher search index over launcher_entries. Every typed character adds
+// a step holding the entries still matching, so the next character only
+// has to look at those.
+struct LauncherSearchIndex {
+    struct Step {
+        std::size_t query_length{0};
+        std::vector<uint32_t> matches; // Ranked
+    };
+
+    std::vector<std::string> haystacks;  // Lowercased "name description category"
+    std::vector<uint32_t> name_lengths;  // Name prefix of each haystack
+    std::vector<uint64_t> masks;         // Characters present in each haystack
+    std::vector<Step> steps;             // steps[0] holds every entry
+    uint64_t generation{0};              // Bumped whenever launcher_entries is reindexed
+};
+
+// Rasterised launcher row text, reused while scrolling and re-highlighting
+struct LauncherRowCache {
+    struct Row {
+        uint32_t entry{0};
+        bool highlighted{false};
+        cairo_surface_t *surface{nullptr};
+        uint64_t last_used{0};
+    };
+    std::vector<Row> rows;
+    int width{0};               // Card size the rows were rasterised for
+    int height{0};
+    uint64_t generation{0};     // LauncherSearchIndex generation of the rows
+    uint64_t use_counter{0};
+};
+
+// One parsed .desktop file
+struct DesktopEntryRecord {
+    std::string id;        // Desktop file ID, e.g. org.gnome.Nautilus.desktop
+    uint32_t directory{0}; // Index into AppCatalog::directories, lower wins
+    int64_t mtime{0};
+    bool hidden{false};    // NoDisplay, Hidden or not an application; still shadows lower directories
+    LauncherEntry entry;
+};
+
+// Installed applications from the XDG application directories. The index is
+// built and kept current on a worker thread; the event loop only ever swaps
+// in finished entry lists.
+struct AppCatalog {
+    std::vector<std::string> directories; // Highest precedence first
+    std::string cache_path;
+    std::string terminal;                 // Runs Terminal=true applications
+
+    std::thread worker;
+    std::mutex mutex;                     // Guards everything down to published
+    std::condition_variable wake;
+    bool stopping{false};
+    bool rescan{false};
+    std::unordered_set<std::string> dirty_paths;
+    std::vector<LauncherEntry> published;
+    bool has_published{false};
+    std::unordered_map<std::string, DesktopEntryRecord> records; // By path, owned by the worker once started
+
+    int notify_fd{-1};                    // eventfd, worker to event loop
+    struct wl_event_source *notify_source{nullptr};
+    int inotify_fd{-1};
+    struct wl_event_source *inotify_source{nullptr};
+    std::unordered_map<int, std::string> watches; // inotify descriptor to watched directory
+    std::unordered_set<std::string> changed;      // Paths seen since the debounce timer was armed
+    bool changed_rescan{false};
+    struct wl_event_source *debounce_timer{nullptr};
+};
+
+// Programs started from the panel, launcher and keybindings
+struct ProcessLauncher {
+    struct wl_event_source *sigchld{nullptr};
+    std::vector<std::string> environment;             // Sanitised copy handed to children
+    std::unordered_map<pid_t, std::string> children;  // Running children, for exit logging
+};
+
+// xdg-activation tokens handed to launched programs, used to pass focus to
+// their first window and to time how long each app takes to show it
+struct LaunchTracker {
+    struct PendingLaunch {
+        std::string app;
+        pid_t pid{-1};
+        uint64_t started_ns{0};
+        bool shown{false}; // First frame already recorded via the pid match
+    };
+    struct AppTimings {
+        uint32_t launches{0};
+        uint64_t total_ms{0};
+        uint32_t last_ms{0};
+        uint32_t worst_ms{0};
+    };
+
+    std::unordered_map<std::string, PendingLaunch> pending; // Keyed by token
+    std::map<std::string, AppTimings> timings;              // Keyed by app name
+    std::string report_path;                                // Empty unless debug.launch_timing is set
+};
+
+// Tiled arrangement of the views on one output. Views stay in their
+// container while floating so switching layouts brings them back.
+struct TilingContainer {
+    ArolloaOutput *output{nullptr};
+    std::vector<ArolloaView *> views; // Tiling order, oldest first
+    struct wlr_box area{};            // Usable layout-space area below the panel
+    bool dirty{false};
+};
+
+struct TilingEngine {
+    std::vector<TilingContainer> containers;
+    std::vector<ArolloaView *> orphans;     // Mapped while no output existed
+    struct wl_event_source *flush{nullptr}; // Idle source batching relayouts
+    std::vector<ArolloaView *> scratch_views;
+    std::vector<struct wlr_box> scratch_tiles;
+};
+
+// Layout changes applied atomically once every affected client has drawn
+// at its new size
+struct LayoutTransaction {
+    struct Instruction {
+        ArolloaView *view{nullptr};
+        struct wlr_box box{}; // Target position and configured size
+        uint32_t serial{0};   // Configure to wait for, 0 when only moving
+        bool ready{false};
+    };
+
+    std::vector<Instruction> instructions;
+    std::size_t waiting{0};
+    uint64_t started_ns{0};
+    struct wl_event_source *timeout{nullptr};
+};
+
+// Floating window placement
+struct PlacementState {
+    uint32_t cascade{0}; // Next cascade slot when no free space is left
+};
+
+// Interactive move/resize started by a client request
+enum class GrabMode : uint8_t {
+    NONE,
+    MOVE,
+    RESIZE
+};
+
+struct CursorGrab {
+    GrabMode mode{GrabMode::NONE};
+    ArolloaView *view{nullptr};
+    double start_x{0.0};          // Cursor position when the grab began
+    double start_y{0.0};
+    struct wlr_box start_box{};   // View box when the grab began
+    uint32_t edges{0};
+    bool forward_release{true};   // The client saw the press that started the grab
+    uint32_t configure_serial{0}; // Outstanding resize configure, 0 if none
+    int sent_width{0};            // Size carried by the last configure
+    int sent_height{0};
+    int wanted_width{0};          // Latest size asked for by the pointer
+    int wanted_height{0};
+};
+
+// Parts of a server-side window frame that react to the pointer
+enum class DecorationHit : uint8_t {
+    NONE,
+    TITLEBAR,
+    CLOSE
+};
+
+// Pointer motion accumulated between pointer frames.
+struct PointerMotionState {
+    bool pending{false};
+    uint32_t time_msec{0};
+    double focus_origin_x{0.0}; // Layout position of the focused surface's origin
+    double focus_origin_y{0.0};
+};
+
+// Uniform grid over mapped view boxes for pointer hit-testing. Each cell
+// keeps its views sorted by stacking order, bottom to top.
+struct ViewSpatialIndex {
+    std::unordered_map<uint64_t, std::vector<ArolloaView *>> cells;
+    uint32_t next_stack_order{1};
+};
+
+// What output_frame needs of a mapped view, kept in a flat array in
+// stacking order, bottom to top. Raising leaves a hole behind that is
+// compacted away once holes outnumber live records.
+enum RenderRecordFlags : uint32_t {
+    RENDER_VISIBLE = 1u << 0,   // Mapped, placed and on an active workspace
+    RENDER_DECORATED = 1u << 1  // Gets Swiss chrome in the UI overlay
+};
+
+struct RenderRecord {
+    ArolloaView *view{nullptr}; // nullptr marks a hole left by raise or unmap
+    struct wlr_surface *surface{nullptr};
+    struct wlr_texture *texture{nullptr};
+    struct wlr_box box{};
+    float opacity{1.0f};
+    uint32_t flags{0};
+    struct ArolloaOutput *frame_output{nullptr}; // Shows most of the view; sends its frame callbacks
+};
+
+struct RenderList {
+    std::vector<RenderRecord> records;
+    std::size_t live{0};
+};
+
+// Downscaled copies of view contents for the overview and the window
+// switcher. A thumbnail is only redrawn when a consumer asks for it after
+// the view committed new content; the least recently used ones go first
+// once the memory budget is exceeded.
+struct ThumbnailCache {
+    struct Thumbnail {
+        ArolloaView *view{nullptr};
+        struct wlr_buffer *buffer{nullptr};
+        struct wlr_texture *texture{nullptr};
+        uint32_t content_seq{0}; // view->content_seq the thumbnail shows
+        std::size_t bytes{0};
+        uint64_t last_used{0};
+        uint64_t last_frame{0};  // Handed out in this frame: must not be freed before it is drawn
+    };
+    std::vector<Thumbnail> thumbnails;
+    std::size_t bytes{0};
+    std::size_t budget{0};       // Soft while the thumbnails in use exceed it
+    uint64_t use_counter{0};
+    uint64_t frame{0};           // Bumped by thumbnail_begin_frame
+    uint32_t refreshes_left{0}; // Redraws still allowed in the current frame
+};
+
+// Every window on an output at once, laid out as a grid of thumbnails
+struct OverviewState {
+    struct Cell {
+        ArolloaView *view{nullptr};
+        struct wlr_box box{};              // Output-local thumbnail box
+        struct wlr_texture *texture{nullptr};
+    };
+    bool visible{false};
+    std::vector<Cell> cells; // Laid out for the output being drawn
+};
+
+// Alt+Tab window switcher. The views are a most-recently-focused snapshot
+// taken when it opens; focus only moves once Alt is released. The panel
+// is a cached layer redrawn only when the selection or the entries change,
+// with live thumbnails composited on top.
+struct WindowSwitcher {
+    bool active{false};
+    ArolloaOutput *output{nullptr};
+    std::vector<ArolloaView *> views;
+    std::size_t selected{0};
+    struct wlr_box box{};                 // Output-local panel box
+    std::vector<struct wlr_box> slots;    // Panel-local thumbnail slots, one per view
+    std::vector<struct wlr_texture *> thumbnails;
+    cairo_surface_t *layer_surface{nullptr};
+    struct wlr_texture *layer{nullptr};
+    bool layer_dirty{true};
+};
+
+// Adaptive quality - effects are shed when frames overrun the refresh budget
+enum class RenderQuality {
+    FULL,
+    REDUCED,  // No window shadows, shortened animations
+    FLAT,     // Flat launcher backgrounds, no hover halos
+    MINIMAL   // Instant transitions
+};
+
+// Reduced motion and low-power pacing for compositor-driven UI animation.
+// Client content always presents at the output refresh rate.
+struct MotionPolicy {
+    bool reduced_motion{false};   // Replace UI transitions with instant changes
+    bool low_power{false};        // Cap the UI animation rate and skip idle frames
+    bool low_power_auto{true};    // Follow battery and remote-session detection
+    int ui_frame_rate{20};
+    std::chrono::steady_clock::time_point last_ui_tick{std::chrono::steady_clock::now()};
+    struct wl_event_source *ui_tick_timer{nullptr};
+    struct wl_event_source *power_poll_timer{nullptr};
+};
+
+struct QualityGovernor {
+    bool enabled{true};
+    RenderQuality level{RenderQuality::FULL};
+    float load{0.0f};          // Smoothed frame time as a fraction of the refresh interval
+    float last_frame_ms{0.0f};
+    int frames_since_change{0};
+};
+
 constexpr int FOREST_PANEL_MENU_WIDTH = 144;
 constexpr int FOREST_LAUNCHER_WIDTH = 520;
 constexpr int FOREST_LAUNCHER_ENTRY_HEIGHT = 68;
@@ -213,12 +665,43 @@ struct ArolloaView {
     struct wl_listener destroy;
     struct wl_listener request_move;
     struct wl_listener request_resize;
+    struct wl_listener commit;
+    struct wl_listener set_title;
+    struct wl_listener request_fullscreen;
     bool mapped;
     int x, y;
+    int width, height; // Size of the last committed surface state
+    struct wlr_box index_box;
+    bool indexed;
+    uint32_t stack_order;
+    uint32_t render_slot; // 1-based index into server->render_list.records, 0 if absent
+    uint32_t content_seq; // Bumped on every commit of a mapped view
+    uint64_t mapped_ns; // CLOCK_MONOTONIC time the view was last mapped
+    struct ArolloaOutput *output; // Output whose tiling container holds the view
+    bool floating;                // Taken out of tiling by a move or resize
+    bool tiled;                   // Client was told it is tiled on all edges
+    int configured_width, configured_height; // Last size sent by tiling
+    bool awaiting_layout;                    // Mapped but not yet placed by a transaction
+    uint32_t workspace;                      // Workspace index on view->output
+    struct wlr_xdg_toplevel_decoration_v1 *decoration; // NULL if the client never asked
+    bool server_decorated;                   // Client acked server-side mode; we draw its frame
+    bool hidden;                             // On an inactive workspace: not drawn, hit or sent frames
+    bool fullscreen;
+    struct wlr_box restore_box;              // Floating geometry to return to after fullscreen
+    struct wlr_buffer *saved_buffer;         // Held while a layout transaction is in flight
+    struct wlr_texture *saved_texture;
 #ifdef __cplusplus
     float opacity;
 #endif
     struct wl_list link;
+    struct wl_list focus_link; // server->focus_order; unlinked while unmapped
+};
+
+struct ArolloaDecoration {
+    struct wlr_xdg_toplevel_decoration_v1 *decoration;
+    struct ArolloaServer *server;
+    struct wl_listener request_mode;
+    struct wl_listener destroy;
 };
 
 struct ArolloaKeyboard {
@@ -233,7 +716,17 @@ struct ArolloaOutput {
     struct wlr_output *wlr_output;
     struct ArolloaServer *server;
     struct timespec last_frame;
+    struct wlr_texture *ui_texture; // Cached Swiss UI overlay for this output
+    struct wlr_damage_ring damage_ring;
+    pixman_region32_t ui_damage; // Overlay boxes to redraw into ui_texture, output-local
+    uint64_t ui_generation;
+    uint64_t content_generation;
+    bool ui_fullscreen;                 // ui_texture only holds what is drawn over a fullscreen view
+    bool direct_ui_failed;              // Software path unusable; the overlay texture is used instead
+    uint32_t active_workspace;
+    struct ArolloaView *fullscreen_view; // Covers the output while it is on top
     struct wl_listener frame;
+    struct wl_listener present;
     struct wl_listener request_state;
     struct wl_listener destroy;
     struct wl_list link;
@@ -251,6 +744,7 @@ struct ArolloaServer {
     struct wlr_xcursor_manager *cursor_mgr;
     struct wlr_output_layout *output_layout;
     struct wlr_xdg_decoration_manager_v1 *decoration_manager;
+    struct wlr_xdg_activation_v1 *activation;
 
     struct wlr_cursor *cursor;
     struct wl_listener cursor_motion;
@@ -267,10 +761,15 @@ struct ArolloaServer {
     struct wl_listener new_input;
     struct wl_listener request_cursor;
     struct wl_listener request_set_selection;
+    struct wl_listener output_layout_change;
+    struct wl_listener request_activate;
+    struct wl_listener new_decoration;
 
     struct wl_list outputs;
     struct wl_list views;
+    struct wl_list focus_order; // Mapped views, most recently focused first
     struct wl_list keyboards;
+    struct ArolloaView *focused_view; // Holds keyboard focus
 
 #ifdef __cplusplus
     WindowLayout layout_mode{WindowLayout::GRID};
@@ -280,6 +779,29 @@ struct ArolloaServer {
     bool initialized{false};
     float startup_opacity{0.0f};
     ForestUIState ui_state{};
+    QualityGovernor quality{};
+    MotionPolicy motion{};
+    ViewSpatialIndex view_index{};
+    RenderList render_list{};
+    ThumbnailCache thumbnails{};
+    OverviewState overview{};
+    WindowSwitcher switcher{};
+    ChromeLayoutCache chrome{};
+    PointerMotionState pointer_motion{};
+    KeymapCache keymaps{};
+    KeybindingEngine bindings{};
+    LatencyTracer latency{};
+    CursorGrab grab{};
+    ProcessLauncher launcher{};
+    LaunchTracker launches{};
+    PlacementState placement{};
+    TilingEngine tiling{};
+    LayoutTransaction transaction{};
+    AppCatalog apps{};
+    LauncherSearchIndex launcher_search{};
+    LauncherRowCache launcher_rows{};
+    uint64_t ui_generation{1};      // Bumped whenever the Cairo overlay must be redrawn
+    uint64_t content_generation{1}; // Bumped whenever client content changes
 #endif
 
     // Swiss design state
@@ -305,7 +827,6 @@ void output_frame(struct wl_listener *listener, void *data);
 
 // Swiss design rendering
 void render_swiss_ui(struct ArolloaServer *server, struct ArolloaOutput *output);
-void render_swiss_panel(cairo_t *cairo, int width, int height, float opacity, const struct ArolloaServer *server);
 void render_swiss_window(cairo_t *cairo, struct ArolloaView *view, float global_opacity);
 void initialize_forest_ui(struct ArolloaServer *server);
 
@@ -323,7 +844,17 @@ void launch_oobe(void);
 }
 
 // C++ only functions
-void animation_tick(ArolloaServer *server);
+bool animation_tick(ArolloaServer *server);
+bool ui_animation_pending(const ArolloaServer *server);
+float ui_animation_scale(const ArolloaServer *server);
+void mark_ui_dirty(ArolloaServer *server);
+void mark_content_dirty(ArolloaServer *server);
+void schedule_output_frames(ArolloaServer *server);
+void mark_region_dirty(ArolloaServer *server, const struct wlr_box &box);
+void damage_view_commit(ArolloaView *view);
+struct wlr_box view_frame_box(const ArolloaView *view);
+struct wlr_box view_box_for_frame(const ArolloaView *view, const struct wlr_box &frame);
+DecorationHit view_decoration_hit(const ArolloaView *view, double lx, double ly);
 void push_animation(ArolloaServer *server, std::unique_ptr<Animation> animation);
 void schedule_startup_animation(ArolloaServer *server);
 void setup_pointer_interactions(struct ArolloaServer *server);
@@ -333,9 +864,171 @@ void toggle_launcher(struct ArolloaServer *server);
 void focus_launcher_offset(struct ArolloaServer *server, int offset);
 bool activate_launcher_selection(struct ArolloaServer *server);
 void update_pointer_hover_state(struct ArolloaServer *server);
+void update_pointer_focus(struct ArolloaServer *server, uint32_t time_msec);
+void cursor_rebase(struct ArolloaServer *server);
+void flush_pointer_motion(struct ArolloaServer *server);
 void show_system_notification(struct ArolloaServer *server, const std::string &title, const std::string &body);
 void show_volume_change(struct ArolloaServer *server, int level);
 std::string get_config_string(const std::string& key, const std::string& default_value);
 int get_config_int(const std::string& key, int default_value);
 bool get_config_bool(const std::string& key, bool default_value);
+std::vector<std::pair<std::string, std::string>> get_config_entries(const std::string& prefix);
+
+// Panel and launcher layout
+void render_swiss_panel(cairo_t *cairo, const ChromeLayout &layout, float opacity, const ArolloaServer *server);
+const ChromeLayout *chrome_layout_for(ArolloaServer *server, ArolloaOutput *output);
+const ChromeLayout *chrome_layout_at(ArolloaServer *server, double lx, double ly);
+ChromeHit chrome_panel_hit(const ChromeLayout &layout, double local_x);
+void chrome_layout_invalidate(ArolloaServer *server);
+void chrome_layout_forget(ArolloaServer *server, ArolloaOutput *output);
+double launcher_clamp_scroll(const LauncherGeometry &geometry, std::size_t count, double scroll);
+LauncherRowRange launcher_visible_rows(const LauncherGeometry &geometry, std::size_t count, double scroll);
+double launcher_row_y(const LauncherGeometry &geometry, std::size_t count, double scroll, std::size_t row);
+int launcher_row_at(const LauncherGeometry &geometry, std::size_t count, double scroll, double local_x, double local_y);
+void launcher_scroll_by(ArolloaServer *server, double delta);
+void launcher_reveal_highlight(ArolloaServer *server);
+void launcher_row_cache_clear(ArolloaServer *server);
+
+// View stacking and hit-testing
+void view_index_update(ArolloaServer *server, ArolloaView *view);
+void view_index_remove(ArolloaServer *server, ArolloaView *view);
+ArolloaView *view_at(ArolloaServer *server, double lx, double ly, struct wlr_surface **surface, double *sx, double *sy);
+ArolloaView *view_decoration_at(ArolloaServer *server, double lx, double ly, DecorationHit *hit);
+void raise_view(ArolloaServer *server, ArolloaView *view);
+void focus_view(ArolloaServer *server, ArolloaView *view);
+void focus_top_view(ArolloaServer *server);
+void render_list_update(ArolloaView *view);
+void render_list_raise(ArolloaView *view);
+void render_list_remove(ArolloaView *view);
+void render_list_outputs_changed(ArolloaServer *server);
+ArolloaOutput *frame_output_for(ArolloaServer *server, const struct wlr_box &box);
+
+// Process launching
+void process_launcher_init(ArolloaServer *server);
+void process_launcher_finish(ArolloaServer *server);
+pid_t spawn_command(ArolloaServer *server, const std::string &command, const std::string &activation_token = {});
+
+// Activation and launch timing
+void activation_init(ArolloaServer *server);
+void activation_finish(ArolloaServer *server);
+pid_t launch_application(ArolloaServer *server, const std::string &name, const std::string &command);
+void activation_view_mapped(ArolloaView *view);
+
+// Window placement
+ArolloaOutput *output_at_cursor(ArolloaServer *server);
+struct wlr_box output_usable_area(ArolloaServer *server, ArolloaOutput *output);
+void place_view(ArolloaView *view);
+
+// Tiling
+bool tiling_view_mapped(ArolloaView *view);
+void tiling_view_unmapped(ArolloaView *view);
+void tiling_float_view(ArolloaView *view);
+void tiling_move_view(ArolloaView *view, ArolloaOutput *output);
+void tiling_set_mode(ArolloaServer *server, WindowLayout mode);
+void tiling_outputs_changed(ArolloaServer *server);
+void tiling_forget_output(ArolloaServer *server, ArolloaOutput *output);
+void tiling_mark_output_dirty(ArolloaServer *server, ArolloaOutput *output);
+void tiling_finish(ArolloaServer *server);
+
+// Server-side decorations
+void decoration_init(ArolloaServer *server);
+void decoration_finish(ArolloaServer *server);
+void decoration_initial_commit(ArolloaView *view);
+void decoration_sync(ArolloaView *view);
+
+// Fullscreen
+void view_set_fullscreen(ArolloaView *view, bool fullscreen, struct wlr_output *wlr_output);
+void fullscreen_view_unmapped(ArolloaView *view);
+void fullscreen_forget_output(ArolloaServer *server, ArolloaOutput *output);
+
+// Thumbnails and overview
+void thumbnail_cache_init(ArolloaServer *server);
+void thumbnail_cache_finish(ArolloaServer *server);
+void thumbnail_begin_frame(ArolloaServer *server);
+struct wlr_texture *thumbnail_get(ArolloaView *view);
+void thumbnail_forget_view(ArolloaView *view);
+void overview_toggle(ArolloaServer *server);
+void overview_layout(ArolloaServer *server, ArolloaOutput *output, std::vector<OverviewState::Cell> &cells);
+void overview_prepare(ArolloaServer *server, ArolloaOutput *output);
+void overview_render(ArolloaServer *server, struct wlr_render_pass *render_pass, const pixman_region32_t *clip);
+void overview_draw_labels(cairo_t *cr, ArolloaServer *server);
+bool overview_handle_click(ArolloaServer *server, const struct wlr_pointer_button_event *event);
+
+// Window switcher
+void switcher_step(ArolloaServer *server, int direction);
+void switcher_commit(ArolloaServer *server);
+void switcher_cancel(ArolloaServer *server);
+void switcher_forget_view(ArolloaView *view);
+void switcher_damage(ArolloaServer *server);
+void switcher_forget_output(ArolloaServer *server, ArolloaOutput *output);
+void switcher_prepare(ArolloaServer *server, ArolloaOutput *output);
+void switcher_render(ArolloaServer *server, ArolloaOutput *output, struct wlr_render_pass *render_pass,
+                     const pixman_region32_t *clip);
+void switcher_finish(ArolloaServer *server);
+
+// Workspaces
+void workspace_view_mapped(ArolloaView *view);
+void workspace_refresh_view(ArolloaView *view);
+void workspace_switch(ArolloaServer *server, ArolloaOutput *output, uint32_t workspace);
+void workspace_move_view(ArolloaServer *server, ArolloaView *view, uint32_t workspace);
+
+// Layout transactions
+void transaction_add(ArolloaServer *server, ArolloaView *view, const struct wlr_box &box, uint32_t serial);
+void transaction_commit(ArolloaServer *server);
+bool transaction_handle_commit(ArolloaView *view);
+void transaction_forget_view(ArolloaView *view);
+void transaction_finish(ArolloaServer *server);
+
+// Interactive move and resize
+void begin_interactive(ArolloaView *view, GrabMode mode, uint32_t edges);
+bool grab_process_motion(ArolloaServer *server);
+void grab_end(ArolloaServer *server);
+void grab_handle_commit(ArolloaView *view);
+
+// Keybindings
+void keybindings_init(ArolloaServer *server);
+void keybindings_finish(ArolloaServer *server);
+bool keybindings_handle_key(ArolloaServer *server, struct wlr_keyboard *keyboard,
+                            const struct wlr_keyboard_key_event *event);
+
+// Latency tracing
+void latency_trace_init(ArolloaServer *server);
+void latency_trace_finish(ArolloaServer *server);
+void latency_trace_input(ArolloaServer *server, LatencySource source, uint32_t event_msec,
+                         const struct wlr_surface *target);
+void latency_trace_surface_commit(ArolloaServer *server, const struct wlr_surface *surface);
+void latency_trace_output_commit(ArolloaServer *server, ArolloaOutput *output);
+void latency_trace_output_present(ArolloaServer *server, ArolloaOutput *output, const struct timespec *when);
+void latency_trace_forget_output(ArolloaServer *server, ArolloaOutput *output);
+std::string latency_trace_summary(const ArolloaServer *server);
+
+// Launcher search
+void launcher_search_rebuild(ArolloaServer *server);
+void launcher_search_append(ArolloaServer *server, const std::string &text);
+void launcher_search_erase(ArolloaServer *server);
+void launcher_search_clear(ArolloaServer *server);
+
+// Application catalog
+void app_catalog_init(ArolloaServer *server);
+void app_catalog_finish(ArolloaServer *server);
+
+// Keymap cache
+struct xkb_keymap *keymap_cache_get(ArolloaServer *server, const struct xkb_rule_names &rules);
+void keymap_cache_finish(ArolloaServer *server);
+
+// Adaptive quality governor
+void quality_governor_init(ArolloaServer *server);
+void quality_governor_record_frame(ArolloaServer *server, const ArolloaOutput *output, float frame_ms);
+const char *render_quality_name(RenderQuality quality);
+float quality_animation_scale(const ArolloaServer *server);
+bool quality_draws_shadows(const ArolloaServer *server);
+bool quality_draws_hover_halos(const ArolloaServer *server);
+bool quality_uses_flat_surfaces(const ArolloaServer *server);
+
+// Reduced motion and low-power mode
+void motion_policy_init(ArolloaServer *server);
+void motion_policy_finish(ArolloaServer *server);
+void set_low_power_mode(ArolloaServer *server, bool enabled);
+void toggle_low_power_mode(ArolloaServer *server);
+void schedule_ui_tick(ArolloaServer *server);
 #endif
@@ -0,0 +1,211 @@
+#include "../../include/arolloa.h"
+
+#include <cstdio>
+#include <ctime>
+
+namespace {
+// Long enough for cold starts of sandboxed apps; programs that never open a
+// window are forgotten after this.
+constexpr uint32_t LAUNCH_TIMEOUT_MS = 120000;
+
+uint64_t monotonic_ns() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+ArolloaView *view_for_surface(ArolloaServer *server, const struct wlr_surface *surface) {
+    ArolloaView *view = nullptr;
+    wl_list_for_each(view, &server->views, link) {
+        if (view->xdg_surface && view->xdg_surface->surface == surface) {
+            return view;
+        }
+    }
+    return nullptr;
+}
+
+void write_report(const LaunchTracker &tracker) {
+    if (tracker.report_path.empty()) {
+        return;
+    }
+    FILE *file = std::fopen(tracker.report_path.c_str(), "w");
+    if (!file) {
+        return;
+    }
+
+    std::fprintf(file, "# arolloa launch to first frame (ms)\n");
+    std::fprintf(file, "# launches last mean worst app\n");
+    for (const auto &[app, timings] : tracker.timings) {
+        std::fprintf(file, "%u %u %llu %u %s\n", timings.launches, timings.last_ms,
+                     static_cast<unsigned long long>(timings.total_ms / timings.launches), timings.worst_ms,
+                     app.c_str());
+    }
+    std::fclose(file);
+}
+
+void record_first_frame(LaunchTracker &tracker, LaunchTracker::PendingLaunch &launch, uint64_t shown_ns) {
+    if (launch.shown) {
+        return;
+    }
+    launch.shown = true;
+
+    const auto elapsed_ms = static_cast<uint32_t>((shown_ns - launch.started_ns) / 1000000ull);
+    auto &timings = tracker.timings[launch.app];
+    ++timings.launches;
+    timings.total_ms += elapsed_ms;
+    timings.last_ms = elapsed_ms;
+    timings.worst_ms = std::max(timings.worst_ms, elapsed_ms);
+    wlr_log(WLR_INFO, "%s showed its first frame %u ms after launch", launch.app.c_str(), elapsed_ms);
+    write_report(tracker);
+}
+
+void prune_expired(LaunchTracker &tracker, uint64_t now) {
+    std::erase_if(tracker.pending, [now](const auto &item) {
+        const auto &launch = item.second;
+        if (now - launch.started_ns < LAUNCH_TIMEOUT_MS * 1000000ull) {
+            return false;
+        }
+        if (!launch.shown) {
+            wlr_log(WLR_DEBUG, "%s never showed a window", launch.app.c_str());
+        }
+        return true;
+    });
+}
+
+// Focus moves on activation only when the request carries a token we handed
+// to a launched program, or one the focused client minted while handing
+// focus on (for example a link opened from a chat window).
+bool may_activate(ArolloaServer *server, const struct wlr_xdg_activation_token_v1 *token, bool launched) {
+    if (launched) {
+        return true;
+    }
+    const ArolloaView *focused = server->focused_view;
+    if (!focused || !token->surface || token->seat != server->seat) {
+        return false;
+    }
+    return wl_resource_get_client(token->surface->resource) ==
+           wl_resource_get_client(focused->xdg_surface->surface->resource);
+}
+
+void handle_request_activate(struct wl_listener *listener, void *data) {
+    ArolloaServer *server = wl_container_of(listener, server, request_activate);
+    auto *event = static_cast<struct wlr_xdg_activation_v1_request_activate_event *>(data);
+    ArolloaView *view = view_for_surface(server, event->surface);
+    if (!view || !view->mapped) {
+        return;
+    }
+
+    auto &tracker = server->launches;
+    const char *name = wlr_xdg_activation_token_v1_get_name(event->token);
+    auto launch = name ? tracker.pending.find(name) : tracker.pending.end();
+    const bool launched = launch != tracker.pending.end();
+    if (launched) {
+        // A window that predates the launch was only raised; the time the
+        // app took to hand over is still what the user waited for.
+        const uint64_t now = monotonic_ns();
+        const uint64_t shown_ns = view->mapped_ns >= launch->second.started_ns ? view->mapped_ns : now;
+        record_first_frame(tracker, launch->second, shown_ns);
+        tracker.pending.erase(launch);
+    }
+
+    if (!may_activate(server, event->token, launched)) {
+        wlr_log(WLR_DEBUG, "Ignoring activation request without a usable token");
+        return;
+    }
+    // A window on another workspace brings its workspace along.
+    if (view->hidden && view->output) {
+        workspace_switch(server, view->output, view->workspace);
+    }
+    focus_view(server, view);
+    cursor_rebase(server);
+}
+} // namespace
+
+void activation_init(ArolloaServer *server) {
+    if (!server || !server->wl_display) {
+        return;
+    }
+
+    server->activation = wlr_xdg_activation_v1_create(server->wl_display);
+    if (!server->activation) {
+        wlr_log(WLR_ERROR, "Failed to create xdg-activation global; launched apps will not receive tokens");
+        return;
+    }
+    server->activation->token_timeout_msec = LAUNCH_TIMEOUT_MS;
+    server->request_activate.notify = handle_request_activate;
+    wl_signal_add(&server->activation->events.request_activate, &server->request_activate);
+
+    auto &tracker = server->launches;
+    if (get_config_bool("debug.launch_timing", false)) {
+        const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+        tracker.report_path = get_config_string("debug.launch_timing_file",
+            std::string(runtime_dir ? runtime_dir : "/tmp") + "/arolloa-launch-times.txt");
+    }
+}
+
+void activation_finish(ArolloaServer *server) {
+    if (!server || !server->activation) {
+        return;
+    }
+
+    // The global itself goes away with the display.
+    wl_list_remove(&server->request_activate.link);
+    server->activation = nullptr;
+    server->launches.pending.clear();
+}
+
+// Starts a program on the user's behalf with a fresh activation token, so
+// its first window can claim focus and be timed. Returns the child pid, or
+// -1 if nothing was started.
+pid_t launch_application(ArolloaServer *server, const std::string &name, const std::string &command) {
+    if (!server) {
+        return -1;
+    }
+
+    struct wlr_xdg_activation_token_v1 *token =
+        server->activation ? wlr_xdg_activation_token_v1_create(server->activation) : nullptr;
+    const char *token_name = token ? wlr_xdg_activation_token_v1_get_name(token) : nullptr;
+    const std::string activation_token = token_name ? token_name : "";
+
+    const uint64_t now = monotonic_ns();
+    const pid_t pid = spawn_command(server, command, activation_token);
+    if (pid < 0) {
+        if (token) {
+            wlr_xdg_activation_token_v1_destroy(token);
+        }
+        return pid;
+    }
+
+    auto &tracker = server->launches;
+    prune_expired(tracker, now);
+    if (!activation_token.empty()) {
+        LaunchTracker::PendingLaunch launch;
+        launch.app = name;
+        launch.pid = pid;
+        launch.started_ns = now;
+        tracker.pending[activation_token] = std::move(launch);
+    }
+    return pid;
+}
+
+// Clients that exec'd directly are matched by pid as soon as their window
+// maps, even if they never use the token themselves.
+void activation_view_mapped(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    view->mapped_ns = monotonic_ns();
+
+    auto &tracker = server->launches;
+    if (tracker.pending.empty()) {
+        return;
+    }
+    prune_expired(tracker, view->mapped_ns);
+
+    pid_t pid = -1;
+    wl_client_get_credentials(wl_resource_get_client(view->xdg_surface->resource), &pid, nullptr, nullptr);
+    for (auto &[token, launch] : tracker.pending) {
+        if (launch.pid == pid && !launch.shown) {
+            record_first_frame(tracker, launch, view->mapped_ns);
+            break;
+        }
+    }
+}
@@ -1,13 +1,23 @@
 #include "../../include/arolloa.h"
 
 #include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <memory>
 #include <utility>
 
 namespace {
 constexpr float STARTUP_ANIMATION_SCALE = SwissDesign::ANIMATION_DURATION * 3.0f;
+constexpr float SETTLE_EPSILON = 0.002f;
+
+bool hover_settled(const ForestUIState &ui) {
+    return ui.menu_hover_progress == (ui.menu_hovered ? 1.0f : 0.0f) &&
+           ui.panel_hover_progress == (ui.hovered_panel_index >= 0 ? 1.0f : 0.0f) &&
+           ui.tray_hover_progress == (ui.hovered_tray_index >= 0 ? 1.0f : 0.0f) &&
+           ui.volume_feedback.visibility == ui.volume_feedback.target_visibility &&
+           ui.launcher_scroll == ui.launcher_scroll_target;
 }
+} // namespace
 
 void Animation::start(float from, float to, float dur, std::function<void(float)> callback) {
     struct timespec ts = {};
@@ -21,7 +31,15 @@ void Animation::start(float from, float to, float dur, std::function<void(float)
 }
 
 void Animation::update(float current_time) {
-    if (!active || duration <= 0.0f) {
+    if (!active) {
+        return;
+    }
+
+    if (duration <= 0.0f) {
+        active = false;
+        if (update_callback) {
+            update_callback(end_value);
+        }
         return;
     }
 
@@ -55,29 +73,68 @@ void schedule_startup_animation(ArolloaServer *server) {
 
     server->startup_opacity = 0.0f;
     auto animation = std::make_unique<Animation>();
-    animation->start(0.0f, 1.0f, STARTUP_ANIMATION_SCALE, [server](float value) {
+    animation->start(0.0f, 1.0f, STARTUP_ANIMATION_SCALE * ui_animation_scale(server), [server](float value) {
         server->startup_opacity = value;
     });
     push_animation(server, std::move(animation));
 }
 
-void animation_tick(ArolloaServer *server) {
+float ui_animation_scale(const ArolloaServer *server) {
     if (!server) {
-        return;
+        return 1.0f;
+    }
+    if (server->motion.reduced_motion) {
+        return 0.0f;
+    }
+    return quality_animation_scale(server);
+}
+
+bool ui_animation_pending(const ArolloaServer *server) {
+    if (!server) {
+        return false;
+    }
+    return !server->animations.empty() || !server->ui_state.notifications.empty() ||
+           server->ui_state.volume_feedback.target_visibility > 0.0f || !hover_settled(server->ui_state);
+}
+
+// Advances compositor-driven UI animation. Returns true when anything visible
+// in the Cairo overlay changed. In low-power mode ticks are capped to the
+// configured UI frame rate and skipped ticks report no change.
+bool animation_tick(ArolloaServer *server) {
+    if (!server) {
+        return false;
     }
 
+    const auto now = std::chrono::steady_clock::now();
+    auto &motion = server->motion;
+    if (motion.low_power && motion.ui_frame_rate > 0 &&
+        now - motion.last_ui_tick < std::chrono::duration<float>(1.0f / motion.ui_frame_rate)) {
+        return false;
+    }
+    motion.last_ui_tick = now;
+
     struct timespec ts = {};
     clock_gettime(CLOCK_MONOTONIC, &ts);
     const float current_time = ts.tv_sec + ts.tv_nsec / 1e9f;
 
-    const auto now = std::chrono::steady_clock::now();
     const float delta = std::chrono::duration<float>(now - server->ui_state.last_animation_tick).count();
     server->ui_state.last_animation_tick = now;
 
-    const auto smooth_step = [delta](float &value, float target, float speed) {
-        const float step = std::clamp(speed * delta, 0.0f, 1.0f);
+    // Lower render quality shortens transitions; reduced motion and the
+    // minimal quality level make them snap.
+    const float motion_scale = ui_animation_scale(server);
+    bool changed = false;
+    const auto smooth_step = [delta, motion_scale, &changed](float &value, float target, float speed) {
+        if (value == target) {
+            return;
+        }
+        const float step = motion_scale > 0.0f ? std::clamp(speed * delta / motion_scale, 0.0f, 1.0f) : 1.0f;
         value += (target - value) * step;
         value = std::clamp(value, 0.0f, 1.0f);
+        if (std::abs(target - value) < SETTLE_EPSILON) {
+            value = target;
+        }
+        changed = true;
     };
 
     smooth_step(server->ui_state.menu_hover_progress, server->ui_state.menu_hovered ? 1.0f : 0.0f, 9.5f);
@@ -89,9 +146,21 @@ void animation_tick(ArolloaServer *server) {
     }
     smooth_step(server->ui_state.volume_feedback.visibility, server->ui_state.volume_feedback.target_visibility, 8.0f);
 
+    // Launcher scrolling eases in pixels rather than as a 0..1 progress.
+    auto &ui = server->ui_state;
+    if (ui.launcher_scroll != ui.launcher_scroll_target) {
+        const float step = motion_scale > 0.0f ? std::clamp(14.0f * delta / motion_scale, 0.0f, 1.0f) : 1.0f;
+        ui.launcher_scroll += (ui.launcher_scroll_target - ui.launcher_scroll) * step;
+        if (std::abs(ui.launcher_scroll_target - ui.launcher_scroll) < 0.5f) {
+            ui.launcher_scroll = ui.launcher_scroll_target;
+        }
+        changed = true;
+    }
+
     for (auto &anim : server->animations) {
         if (anim && anim->active) {
             anim->update(current_time);
+            changed = true;
         }
     }
 
@@ -105,14 +174,18 @@ void animation_tick(ArolloaServer *server) {
         if (age > notification.lifetime) {
             notification.target_opacity = 0.0f;
         }
-        const float speed = notification.is_volume ? 10.0f : 6.0f;
-        const float step = std::clamp(speed * delta, 0.0f, 1.0f);
-        notification.opacity += (notification.target_opacity - notification.opacity) * step;
-        notification.opacity = std::clamp(notification.opacity, 0.0f, 1.0f);
+        smooth_step(notification.opacity, notification.target_opacity, notification.is_volume ? 10.0f : 6.0f);
     }
 
+    const std::size_t notification_count = server->ui_state.notifications.size();
     server->ui_state.notifications.erase(std::remove_if(server->ui_state.notifications.begin(), server->ui_state.notifications.end(),
         [](const ForestUIState::Notification &notification) {
             return notification.opacity <= 0.02f && notification.target_opacity <= 0.0f;
         }), server->ui_state.notifications.end());
+    changed = changed || notification_count != server->ui_state.notifications.size();
+
+    if (changed) {
+        ++server->ui_generation;
+    }
+    return changed;
 }
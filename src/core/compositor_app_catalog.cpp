@@ -0,0 +1,837 @@
+#include "../../include/arolloa.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <strings.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+constexpr int DEBOUNCE_MS = 250;
+constexpr const char *DESKTOP_NAME = "Arolloa";
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+// Binary cache layout: header, fixed-size records, then a string table of
+// NUL-terminated strings addressed by offset. The file is mapped read-only
+// and never parsed line by line.
+constexpr char CACHE_MAGIC[8] = {'A', 'R', 'O', 'A', 'P', 'P', '0', '2'};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t record_count;
+    uint32_t strings_size;
+    uint32_t key;          // String offset of cache_key() as of when the cache was built
+    uint32_t reserved;
+};
+
+struct CacheRecord {
+    int64_t mtime;
+    uint32_t path;
+    uint32_t id;
+    uint32_t name;
+    uint32_t command;
+    uint32_t description;
+    uint32_t category;
+    uint32_t directory;
+    uint32_t hidden;
+};
+
+std::string data_home() {
+    const char *value = getenv("XDG_DATA_HOME");
+    if (value && *value) {
+        return value;
+    }
+    const char *home = getenv("HOME");
+    return home && *home ? std::string(home) + "/.local/share" : std::string();
+}
+
+std::string cache_home() {
+    const char *value = getenv("XDG_CACHE_HOME");
+    if (value && *value) {
+        return value;
+    }
+    const char *home = getenv("HOME");
+    return home && *home ? std::string(home) + "/.cache" : std::string();
+}
+
+// $XDG_DATA_HOME first, then $XDG_DATA_DIRS in order. Flatpak exports are
+// normally already listed by the session profile; they are appended with
+// the lowest precedence when missing.
+std::vector<std::string> application_directories() {
+    std::vector<std::string> directories;
+    auto add = [&directories](const std::string &base) {
+        if (base.empty()) {
+            return;
+        }
+        const std::string path = base + "/applications";
+        if (std::find(directories.begin(), directories.end(), path) == directories.end()) {
+            directories.push_back(path);
+        }
+    };
+
+    const std::string home = data_home();
+    add(home);
+
+    const char *data_dirs = getenv("XDG_DATA_DIRS");
+    std::stringstream stream(data_dirs && *data_dirs ? data_dirs : "/usr/local/share:/usr/share");
+    std::string base;
+    while (std::getline(stream, base, ':')) {
+        add(base);
+    }
+
+    if (!home.empty()) {
+        add(home + "/flatpak/exports/share");
+    }
+    add("/var/lib/flatpak/exports/share");
+    return directories;
+}
+
+std::string join_directories(const std::vector<std::string> &directories) {
+    std::string joined;
+    for (const auto &directory : directories) {
+        joined += directory;
+        joined.push_back(':');
+    }
+    return joined;
+}
+
+int64_t modification_time(const struct stat &info) {
+    return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+// Locale suffixes in order of preference for a POSIX locale such as
+// de_CH.UTF-8@euro: de_CH@euro, de_CH, de@euro, de.
+std::vector<std::string> locale_candidates() {
+    const char *locale = nullptr;
+    for (const char *variable : {"LC_ALL", "LC_MESSAGES", "LANG"}) {
+        locale = getenv(variable);
+        if (locale && *locale) {
+            break;
+        }
+    }
+    if (!locale || !*locale || std::strcmp(locale, "C") == 0 || std::strcmp(locale, "POSIX") == 0) {
+        return {};
+    }
+
+    std::string value = locale;
+    std::string modifier;
+    if (const auto at = value.find('@'); at != std::string::npos) {
+        modifier = value.substr(at);
+        value.erase(at);
+    }
+    if (const auto dot = value.find('.'); dot != std::string::npos) {
+        value.erase(dot);
+    }
+    std::string language = value;
+    std::string country;
+    if (const auto underscore = value.find('_'); underscore != std::string::npos) {
+        language = value.substr(0, underscore);
+        country = value.substr(underscore);
+    }
+
+    std::vector<std::string> candidates;
+    if (!country.empty() && !modifier.empty()) {
+        candidates.push_back(language + country + modifier);
+    }
+    if (!country.empty()) {
+        candidates.push_back(language + country);
+    }
+    if (!modifier.empty()) {
+        candidates.push_back(language + modifier);
+    }
+    candidates.push_back(language);
+    return candidates;
+}
+
+std::string unescape_value(const std::string &value) {
+    std::string result;
+    result.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            result.push_back(value[i]);
+            continue;
+        }
+        switch (value[++i]) {
+            case 's':
+                result.push_back(' ');
+                break;
+            case 'n':
+                result.push_back('\n');
+                break;
+            case 't':
+                result.push_back('\t');
+                break;
+            case 'r':
+                result.push_back('\r');
+                break;
+            default:
+                // Keep other escapes for the Exec quoting rules.
+                result.push_back('\\');
+                result.push_back(value[i]);
+                break;
+        }
+    }
+    return result;
+}
+
+// Drops %f, %U and friends; the launcher never passes files or URLs.
+std::string strip_field_codes(const std::string &exec) {
+    std::string command;
+    for (std::size_t i = 0; i < exec.size(); ++i) {
+        if (exec[i] != '%' || i + 1 == exec.size()) {
+            command.push_back(exec[i]);
+            continue;
+        }
+        if (exec[++i] == '%') {
+            command.push_back('%');
+        }
+    }
+    while (!command.empty() && command.back() == ' ') {
+        command.pop_back();
+    }
+    return command;
+}
+
+bool list_contains(const std::string &list, const char *item) {
+    std::stringstream stream(list);
+    std::string entry;
+    while (std::getline(stream, entry, ';')) {
+        if (entry == item) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads the [Desktop Entry] group of one file. Returns false if the file
+// could not be read at all.
+bool parse_desktop_file(const std::string &path, const std::vector<std::string> &locales,
+                        const std::string &terminal, DesktopEntryRecord &record) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    // Best localized value per key: rank 0 is the preferred locale, the
+    // unlocalized key ranks after every locale candidate.
+    struct Localized {
+        std::size_t rank{SIZE_MAX};
+        std::string value;
+    };
+    std::unordered_map<std::string, Localized> values;
+
+    bool in_entry = false;
+    bool seen_entry = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            if (seen_entry) {
+                break;
+            }
+            in_entry = line.rfind("[Desktop Entry]", 0) == 0;
+            seen_entry = in_entry;
+            continue;
+        }
+        if (!in_entry) {
+            continue;
+        }
+
+        const auto equals = line.find('=');
+        if (equals == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, equals);
+        while (!key.empty() && key.back() == ' ') {
+            key.pop_back();
+        }
+        std::size_t value_start = equals + 1;
+        while (value_start < line.size() && line[value_start] == ' ') {
+            ++value_start;
+        }
+
+        std::size_t rank = locales.size();
+        if (const auto bracket = key.find('['); bracket != std::string::npos) {
+            const std::string locale = key.substr(bracket + 1, key.size() - bracket - 2);
+            const auto match = std::find(locales.begin(), locales.end(), locale);
+            if (match == locales.end()) {
+                continue;
+            }
+            rank = static_cast<std::size_t>(match - locales.begin());
+            key.erase(bracket);
+        }
+
+        auto &slot = values[key];
+        if (rank < slot.rank) {
+            slot.rank = rank;
+            slot.value = unescape_value(line.substr(value_start));
+        }
+    }
+
+    auto get = [&values](const char *key) -> const std::string & {
+        static const std::string empty;
+        const auto it = values.find(key);
+        return it == values.end() ? empty : it->second.value;
+    };
+
+    auto &entry = record.entry;
+    entry.name = get("Name");
+    entry.command = strip_field_codes(get("Exec"));
+    entry.description = get("Comment");
+    if (entry.description.empty()) {
+        entry.description = get("GenericName");
+    }
+    const std::string &categories = get("Categories");
+    entry.category = categories.substr(0, categories.find(';'));
+    if (get("Terminal") == "true" && !entry.command.empty()) {
+        entry.command = terminal + " -e " + entry.command;
+    }
+
+    const std::string &only_show_in = get("OnlyShowIn");
+    record.hidden = !seen_entry || get("Type") != "Application" || get("NoDisplay") == "true" ||
+                    get("Hidden") == "true" || entry.name.empty() || entry.command.empty() ||
+                    (!only_show_in.empty() && !list_contains(only_show_in, DESKTOP_NAME)) ||
+                    list_contains(get("NotShowIn"), DESKTOP_NAME);
+    return true;
+}
+
+// Desktop file ID: path below the applications directory with '/' as '-'.
+std::string desktop_id(const std::string &directory, const std::string &path) {
+    std::string id = path.substr(directory.size() + 1);
+    std::replace(id.begin(), id.end(), '/', '-');
+    return id;
+}
+
+bool is_desktop_file(const std::string &path) {
+    return path.size() > 8 && path.compare(path.size() - 8, 8, ".desktop") == 0;
+}
+
+// Worker-side context that never changes after startup.
+struct ScanContext {
+    const std::vector<std::string> &directories;
+    const std::vector<std::string> locales;
+    const std::string &terminal;
+};
+
+// Brings one path up to date. Returns true if the catalog changed.
+bool refresh_path(AppCatalog &catalog, const ScanContext &context, uint32_t directory, const std::string &path,
+                  const struct stat &info) {
+    auto it = catalog.records.find(path);
+    const int64_t mtime = modification_time(info);
+    if (it != catalog.records.end() && it->second.mtime == mtime && it->second.directory == directory) {
+        return false;
+    }
+
+    DesktopEntryRecord record;
+    record.id = desktop_id(context.directories[directory], path);
+    record.directory = directory;
+    record.mtime = mtime;
+    if (!parse_desktop_file(path, context.locales, context.terminal, record)) {
+        return false;
+    }
+    catalog.records[path] = std::move(record);
+    return true;
+}
+
+// Full pass over every directory. Unchanged files cost one stat; only new
+// or modified files are parsed.
+bool scan_all(AppCatalog &catalog, const ScanContext &context) {
+    bool changed = false;
+    std::unordered_set<std::string> seen;
+    seen.reserve(catalog.records.size());
+
+    for (uint32_t directory = 0; directory < context.directories.size(); ++directory) {
+        std::error_code error;
+        std::filesystem::recursive_directory_iterator it(context.directories[directory],
+            std::filesystem::directory_options::follow_directory_symlink |
+            std::filesystem::directory_options::skip_permission_denied, error);
+        for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            const std::string path = it->path().string();
+            struct stat info = {};
+            if (!is_desktop_file(path) || stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+                continue;
+            }
+            // The same path can be reached through two listed directories;
+            // the first one wins.
+            if (!seen.insert(path).second) {
+                continue;
+            }
+            changed = refresh_path(catalog, context, directory, path, info) || changed;
+        }
+    }
+
+    for (auto it = catalog.records.begin(); it != catalog.records.end();) {
+        if (seen.count(it->first)) {
+            ++it;
+        } else {
+            it = catalog.records.erase(it);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Applies the paths reported by inotify. Returns false in *needs_rescan
+// when a path cannot be handled on its own, such as a new subdirectory.
+bool update_paths(AppCatalog &catalog, const ScanContext &context, const std::unordered_set<std::string> &paths,
+                  bool *needs_rescan) {
+    bool changed = false;
+    for (const auto &path : paths) {
+        uint32_t directory = 0;
+        while (directory < context.directories.size() &&
+               path.rfind(context.directories[directory] + "/", 0) != 0) {
+            ++directory;
+        }
+        if (directory == context.directories.size()) {
+            continue;
+        }
+
+        struct stat info = {};
+        if (stat(path.c_str(), &info) != 0) {
+            changed = catalog.records.erase(path) > 0 || changed;
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            *needs_rescan = true;
+            return changed;
+        }
+        if (is_desktop_file(path) && S_ISREG(info.st_mode)) {
+            changed = refresh_path(catalog, context, directory, path, info) || changed;
+        }
+    }
+    return changed;
+}
+
+// Resolves desktop IDs by directory precedence and returns the visible
+// entries sorted by name.
+std::vector<LauncherEntry> build_entries(const std::unordered_map<std::string, DesktopEntryRecord> &records) {
+    std::unordered_map<std::string, const DesktopEntryRecord *> by_id;
+    by_id.reserve(records.size());
+    for (const auto &item : records) {
+        const DesktopEntryRecord &record = item.second;
+        auto [it, inserted] = by_id.emplace(record.id, &record);
+        if (!inserted && record.directory < it->second->directory) {
+            it->second = &record;
+        }
+    }
+
+    std::vector<const DesktopEntryRecord *> visible;
+    visible.reserve(by_id.size());
+    for (const auto &item : by_id) {
+        if (!item.second->hidden) {
+            visible.push_back(item.second);
+        }
+    }
+    std::sort(visible.begin(), visible.end(), [](const DesktopEntryRecord *a, const DesktopEntryRecord *b) {
+        const int order = strcasecmp(a->entry.name.c_str(), b->entry.name.c_str());
+        return order != 0 ? order < 0 : a->id < b->id;
+    });
+
+    std::vector<LauncherEntry> entries;
+    entries.reserve(visible.size());
+    for (const auto *record : visible) {
+        entries.push_back(record->entry);
+    }
+    return entries;
+}
+
+// Everything the parsed records depend on besides the files themselves: the
+// directory list, the locale names are picked for and the terminal that
+// Terminal=true commands are wrapped in.
+std::string cache_key(const AppCatalog &catalog) {
+    std::string key = join_directories(catalog.directories);
+    key.push_back('\n');
+    for (const auto &locale : locale_candidates()) {
+        key += locale;
+        key.push_back(':');
+    }
+    key.push_back('\n');
+    key += catalog.terminal;
+    return key;
+}
+
+bool load_cache(AppCatalog &catalog) {
+    const int fd = open(catalog.cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(CacheHeader)) {
+        close(fd);
+        return false;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const auto *bytes = static_cast<const char *>(mapping);
+    const auto *header = reinterpret_cast<const CacheHeader *>(bytes);
+    const std::size_t records_size = static_cast<std::size_t>(header->record_count) * sizeof(CacheRecord);
+    const char *strings = bytes + sizeof(CacheHeader) + records_size;
+    bool valid = std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+                 size == sizeof(CacheHeader) + records_size + header->strings_size && header->strings_size > 0 &&
+                 strings[header->strings_size - 1] == '\0' && header->key < header->strings_size &&
+                 cache_key(catalog) == strings + header->key;
+
+    const auto *records = reinterpret_cast<const CacheRecord *>(bytes + sizeof(CacheHeader));
+    for (uint32_t i = 0; valid && i < header->record_count; ++i) {
+        const CacheRecord &cached = records[i];
+        for (uint32_t offset : {cached.path, cached.id, cached.name, cached.command, cached.description,
+                                cached.category}) {
+            valid = valid && offset < header->strings_size;
+        }
+        valid = valid && cached.directory < catalog.directories.size();
+        if (!valid) {
+            break;
+        }
+
+        DesktopEntryRecord record;
+        record.id = strings + cached.id;
+        record.directory = cached.directory;
+        record.mtime = cached.mtime;
+        record.hidden = cached.hidden != 0;
+        record.entry = {strings + cached.name, strings + cached.command, strings + cached.description,
+                        strings + cached.category};
+        catalog.records.emplace(strings + cached.path, std::move(record));
+    }
+    munmap(mapping, size);
+
+    if (!valid) {
+        catalog.records.clear();
+    }
+    return valid;
+}
+
+void store_cache(const AppCatalog &catalog) {
+    std::string strings;
+    auto intern = [&strings](const std::string &value) {
+        const auto offset = static_cast<uint32_t>(strings.size());
+        strings.append(value).push_back('\0');
+        return offset;
+    };
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.record_count = static_cast<uint32_t>(catalog.records.size());
+    header.key = intern(cache_key(catalog));
+
+    std::vector<CacheRecord> records;
+    records.reserve(catalog.records.size());
+    for (const auto &item : catalog.records) {
+        const DesktopEntryRecord &record = item.second;
+        CacheRecord cached = {};
+        cached.mtime = record.mtime;
+        cached.path = intern(item.first);
+        cached.id = intern(record.id);
+        cached.name = intern(record.entry.name);
+        cached.command = intern(record.entry.command);
+        cached.description = intern(record.entry.description);
+        cached.category = intern(record.entry.category);
+        cached.directory = record.directory;
+        cached.hidden = record.hidden ? 1 : 0;
+        records.push_back(cached);
+    }
+    header.strings_size = static_cast<uint32_t>(strings.size());
+
+    const std::filesystem::path path = catalog.cache_path;
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+        return;
+    }
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(CacheRecord)));
+        file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!file) {
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+void worker_main(AppCatalog *catalog) {
+    const ScanContext context{catalog->directories, locale_candidates(), catalog->terminal};
+
+    std::unique_lock<std::mutex> lock(catalog->mutex);
+    while (true) {
+        catalog->wake.wait(lock, [catalog] {
+            return catalog->stopping || catalog->rescan || !catalog->dirty_paths.empty();
+        });
+        if (catalog->stopping) {
+            return;
+        }
+        bool full = std::exchange(catalog->rescan, false);
+        const auto paths = std::move(catalog->dirty_paths);
+        catalog->dirty_paths.clear();
+        lock.unlock();
+
+        bool changed = false;
+        if (!full) {
+            changed = update_paths(*catalog, context, paths, &full);
+        }
+        if (full) {
+            changed = scan_all(*catalog, context) || changed;
+        }
+
+        std::vector<LauncherEntry> entries;
+        if (changed) {
+            entries = build_entries(catalog->records);
+            store_cache(*catalog);
+        }
+
+        lock.lock();
+        if (changed) {
+            catalog->published = std::move(entries);
+            catalog->has_published = true;
+            const uint64_t one = 1;
+            if (write(catalog->notify_fd, &one, sizeof(one)) < 0) {
+                wlr_log(WLR_DEBUG, "Application catalog wakeup already pending");
+            }
+        }
+    }
+}
+
+void apply_entries(ArolloaServer *server, std::vector<LauncherEntry> entries) {
+    auto &ui = server->ui_state;
+    ui.launcher_entries = ui.builtin_entries;
+    ui.launcher_entries.insert(ui.launcher_entries.end(), std::make_move_iterator(entries.begin()),
+                               std::make_move_iterator(entries.end()));
+    launcher_search_rebuild(server);
+    chrome_layout_invalidate(server);
+}
+
+int handle_catalog_ready(int fd, uint32_t mask, void *data) {
+    (void)mask;
+    auto *server = static_cast<ArolloaServer *>(data);
+    auto &catalog = server->apps;
+
+    uint64_t count = 0;
+    if (read(fd, &count, sizeof(count)) < 0) {
+        return 0;
+    }
+
+    std::vector<LauncherEntry> entries;
+    {
+        std::lock_guard<std::mutex> lock(catalog.mutex);
+        if (!catalog.has_published) {
+            return 0;
+        }
+        entries = std::move(catalog.published);
+        catalog.published.clear();
+        catalog.has_published = false;
+    }
+    wlr_log(WLR_DEBUG, "Application catalog updated: %zu entries", entries.size());
+    apply_entries(server, std::move(entries));
+    return 0;
+}
+
+// Whether a directory at path is, contains or lies within an application
+// directory. Parents watched for a missing directory see unrelated ones too.
+bool affects_directories(const AppCatalog &catalog, const std::string &path) {
+    for (const auto &directory : catalog.directories) {
+        if (directory == path || directory.rfind(path + "/", 0) == 0 || path.rfind(directory + "/", 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int handle_inotify(int fd, uint32_t mask, void *data) {
+    (void)mask;
+    auto *server = static_cast<ArolloaServer *>(data);
+    auto &catalog = server->apps;
+
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length = 0;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (char *cursor = buffer; cursor < buffer + length;) {
+            const auto *event = reinterpret_cast<const struct inotify_event *>(cursor);
+            cursor += sizeof(struct inotify_event) + event->len;
+
+            // A watched directory went away; if it was an application
+            // directory, its closest parent is watched again instead.
+            if (event->mask & IN_IGNORED) {
+                catalog.watches.erase(event->wd);
+                catalog.changed_rescan = true;
+                continue;
+            }
+            if (event->mask & IN_Q_OVERFLOW) {
+                catalog.changed_rescan = true;
+                continue;
+            }
+            const auto watch = catalog.watches.find(event->wd);
+            if (watch == catalog.watches.end() || event->len == 0) {
+                continue;
+            }
+            const std::string path = watch->second + "/" + event->name;
+            // A directory that appears or goes away may hold any number of
+            // entries: rescan, and pick up new directories to watch.
+            if (event->mask & IN_ISDIR) {
+                catalog.changed_rescan = catalog.changed_rescan || affects_directories(catalog, path);
+            } else if (is_desktop_file(path)) {
+                catalog.changed.insert(path);
+            }
+        }
+    }
+
+    // Package managers touch many files at once; wait for the burst to end.
+    if (catalog.debounce_timer) {
+        wl_event_source_timer_update(catalog.debounce_timer, DEBOUNCE_MS);
+    }
+    return 0;
+}
+
+// Watches every application directory and its subdirectories. One that
+// does not exist yet is covered by a watch on its closest existing parent:
+// the directory appearing there triggers a rescan and another call.
+void add_watches(AppCatalog &catalog) {
+    auto add = [&catalog](const std::string &path) {
+        const int watch = inotify_add_watch(catalog.inotify_fd, path.c_str(), WATCH_MASK);
+        if (watch >= 0) {
+            catalog.watches[watch] = path;
+        }
+    };
+
+    for (const auto &directory : catalog.directories) {
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error)) {
+            std::filesystem::path parent = std::filesystem::path(directory).parent_path();
+            while (!parent.empty() && !std::filesystem::is_directory(parent, error)) {
+                parent = parent.parent_path();
+            }
+            if (!parent.empty()) {
+                add(parent.string());
+            }
+            continue;
+        }
+
+        add(directory);
+        std::filesystem::recursive_directory_iterator it(directory,
+            std::filesystem::directory_options::follow_directory_symlink |
+            std::filesystem::directory_options::skip_permission_denied, error);
+        for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            std::error_code type_error;
+            if (it->is_directory(type_error)) {
+                add(it->path().string());
+            }
+        }
+    }
+}
+
+int handle_debounce(void *data) {
+    auto *server = static_cast<ArolloaServer *>(data);
+    auto &catalog = server->apps;
+    if (catalog.changed_rescan) {
+        add_watches(catalog);
+    }
+    {
+        std::lock_guard<std::mutex> lock(catalog.mutex);
+        catalog.dirty_paths.merge(catalog.changed);
+        catalog.rescan = catalog.rescan || catalog.changed_rescan;
+    }
+    catalog.changed.clear();
+    catalog.changed_rescan = false;
+    catalog.wake.notify_one();
+    return 0;
+}
+
+void watch_directories(ArolloaServer *server, struct wl_event_loop *loop) {
+    auto &catalog = server->apps;
+    catalog.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (catalog.inotify_fd < 0) {
+        wlr_log(WLR_ERROR, "Failed to watch application directories: %s", std::strerror(errno));
+        return;
+    }
+
+    add_watches(catalog);
+    catalog.inotify_source = wl_event_loop_add_fd(loop, catalog.inotify_fd, WL_EVENT_READABLE, handle_inotify,
+                                                  server);
+    catalog.debounce_timer = wl_event_loop_add_timer(loop, handle_debounce, server);
+}
+} // namespace
+
+// Seeds the launcher from the on-disk cache, if any, and starts the worker
+// that validates it against the application directories.
+void app_catalog_init(ArolloaServer *server) {
+    if (!server || !server->wl_display) {
+        return;
+    }
+
+    auto &catalog = server->apps;
+    catalog.directories = application_directories();
+    catalog.terminal = get_config_string("launcher.terminal", "foot");
+    const std::string cache = cache_home();
+    if (!cache.empty()) {
+        catalog.cache_path = cache + "/arolloa/applications.bin";
+    }
+
+    if (!catalog.cache_path.empty() && load_cache(catalog)) {
+        wlr_log(WLR_DEBUG, "Loaded %zu cached desktop entries", catalog.records.size());
+        apply_entries(server, build_entries(catalog.records));
+    }
+
+    struct wl_event_loop *loop = wl_display_get_event_loop(server->wl_display);
+    catalog.notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (catalog.notify_fd < 0) {
+        wlr_log(WLR_ERROR, "Failed to create application catalog eventfd: %s", std::strerror(errno));
+        return;
+    }
+    catalog.notify_source = wl_event_loop_add_fd(loop, catalog.notify_fd, WL_EVENT_READABLE, handle_catalog_ready,
+                                                 server);
+    watch_directories(server, loop);
+
+    catalog.rescan = true;
+    catalog.worker = std::thread(worker_main, &catalog);
+}
+
+void app_catalog_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &catalog = server->apps;
+    if (catalog.worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(catalog.mutex);
+            catalog.stopping = true;
+        }
+        catalog.wake.notify_one();
+        catalog.worker.join();
+    }
+
+    for (struct wl_event_source **source : {&catalog.notify_source, &catalog.inotify_source,
+                                            &catalog.debounce_timer}) {
+        if (*source) {
+            wl_event_source_remove(*source);
+            *source = nullptr;
+        }
+    }
+    for (int *fd : {&catalog.notify_fd, &catalog.inotify_fd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    catalog.watches.clear();
+    catalog.records.clear();
+}
@@ -0,0 +1,295 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double PANEL_APP_ICON = 28.0;
+constexpr double PANEL_APP_SPACING = 18.0;
+constexpr double TRAY_ICON = 24.0;
+constexpr double TRAY_SPACING = 20.0;
+constexpr double TRAY_MARGIN = 20.0;
+
+// Hover halos extend past the icon; the halo is what the user sees light up,
+// so it is also what the pointer has to hit.
+constexpr double HALO_PAD = 6.0;
+
+constexpr double LAUNCHER_MARGIN = 120.0;
+constexpr double LAUNCHER_CHROME_HEIGHT = 160.0;
+constexpr double LAUNCHER_HEADER_HEIGHT = 96.0;
+constexpr double LAUNCHER_FOOTER_HEIGHT = LAUNCHER_CHROME_HEIGHT - LAUNCHER_HEADER_HEIGHT;
+constexpr double LAUNCHER_ENTRY_INSET = 32.0;
+constexpr double LAUNCHER_ENTRY_GAP = 10.0;
+
+void fill_columns(std::vector<ChromeHit> &columns, double from, double to, ChromeTarget target, int index) {
+    const int first = std::max(0, static_cast<int>(std::floor(from)));
+    const int last = std::min(static_cast<int>(columns.size()), static_cast<int>(std::ceil(to)));
+    for (int column = first; column < last; ++column) {
+        columns[static_cast<std::size_t>(column)] = ChromeHit{target, static_cast<int16_t>(index)};
+    }
+}
+
+void build_panel(ChromeLayout &layout, const ForestUIState &ui) {
+    const int width = layout.layout_box.width;
+
+    layout.panel_apps.clear();
+    const double app_y = (SwissDesign::PANEL_HEIGHT - PANEL_APP_ICON) / 2.0;
+    double x = FOREST_PANEL_MENU_WIDTH + PANEL_APP_SPACING;
+    for (std::size_t index = 0; index < ui.panel_apps.size(); ++index) {
+        layout.panel_apps.push_back({x, app_y, PANEL_APP_ICON, PANEL_APP_ICON});
+        x += PANEL_APP_ICON + PANEL_APP_SPACING;
+    }
+
+    // Tray icons are laid out right to left from the panel edge.
+    layout.tray_icons.assign(ui.tray_icons.size(), ChromeRect{});
+    const double tray_y = SwissDesign::PANEL_HEIGHT / 2.0 - TRAY_ICON / 2.0;
+    x = static_cast<double>(width) - TRAY_MARGIN;
+    for (int index = static_cast<int>(ui.tray_icons.size()) - 1; index >= 0; --index) {
+        x -= TRAY_ICON;
+        layout.tray_icons[static_cast<std::size_t>(index)] = {x, tray_y, TRAY_ICON, TRAY_ICON};
+        x -= TRAY_SPACING;
+    }
+
+    layout.panel_columns.assign(static_cast<std::size_t>(std::max(width, 0)), ChromeHit{});
+    fill_columns(layout.panel_columns, 0.0, FOREST_PANEL_MENU_WIDTH, ChromeTarget::MENU, 0);
+    for (std::size_t index = 0; index < layout.panel_apps.size(); ++index) {
+        const auto &rect = layout.panel_apps[index];
+        fill_columns(layout.panel_columns, rect.x - HALO_PAD, rect.x + rect.width + HALO_PAD,
+                     ChromeTarget::PANEL_APP, static_cast<int>(index));
+    }
+    for (std::size_t index = 0; index < layout.tray_icons.size(); ++index) {
+        const auto &rect = layout.tray_icons[index];
+        fill_columns(layout.panel_columns, rect.x - HALO_PAD, rect.x + rect.width + HALO_PAD,
+                     ChromeTarget::TRAY_ICON, static_cast<int>(index));
+    }
+}
+
+void build_launcher(ChromeLayout &layout, const ForestUIState &ui) {
+    const double width = layout.layout_box.width;
+    const double height = layout.layout_box.height;
+
+    auto &launcher = layout.launcher;
+    launcher.panel.width = std::min<double>(FOREST_LAUNCHER_WIDTH, width - LAUNCHER_MARGIN);
+    launcher.panel.height = std::min<double>(height * 0.62,
+        std::max<double>(SwissDesign::PANEL_HEIGHT * 5.0,
+            ui.launcher_matches.size() * FOREST_LAUNCHER_ENTRY_HEIGHT + LAUNCHER_CHROME_HEIGHT));
+    launcher.panel.x = (width - launcher.panel.width) / 2.0;
+    launcher.panel.y = (height - launcher.panel.height) / 2.0;
+
+    launcher.entry_x = launcher.panel.x + LAUNCHER_ENTRY_INSET;
+    launcher.entry_y = launcher.panel.y + LAUNCHER_HEADER_HEIGHT;
+    launcher.entry_width = launcher.panel.width - 2.0 * LAUNCHER_ENTRY_INSET;
+    launcher.entry_pitch = FOREST_LAUNCHER_ENTRY_HEIGHT;
+    launcher.entry_height = FOREST_LAUNCHER_ENTRY_HEIGHT - LAUNCHER_ENTRY_GAP;
+    launcher.rows_height = std::max(0.0, launcher.panel.height - LAUNCHER_HEADER_HEIGHT - LAUNCHER_FOOTER_HEIGHT);
+}
+
+void build_layout(ChromeLayout &layout, ArolloaServer *server, ArolloaOutput *output) {
+    layout.output = output;
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &layout.layout_box);
+
+    const auto &ui = server->ui_state;
+    layout.panel_app_count = ui.panel_apps.size();
+    layout.tray_icon_count = ui.tray_icons.size();
+    layout.launcher_entry_count = ui.launcher_matches.size();
+    build_panel(layout, ui);
+    build_launcher(layout, ui);
+}
+
+bool layout_matches_ui(const ChromeLayout &layout, const ForestUIState &ui) {
+    return layout.panel_app_count == ui.panel_apps.size() && layout.tray_icon_count == ui.tray_icons.size() &&
+           layout.launcher_entry_count == ui.launcher_matches.size();
+}
+
+void rebuild_all(ArolloaServer *server) {
+    auto &cache = server->chrome;
+    cache.outputs.clear();
+
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        ChromeLayout layout;
+        build_layout(layout, server, output);
+        if (wlr_box_empty(&layout.layout_box)) {
+            continue;
+        }
+        cache.outputs.push_back(std::move(layout));
+    }
+    cache.stale = false;
+}
+
+ChromeLayout *find_layout(ArolloaServer *server, ArolloaOutput *output) {
+    if (server->chrome.stale) {
+        rebuild_all(server);
+    }
+
+    for (auto &layout : server->chrome.outputs) {
+        if (layout.output == output) {
+            if (!layout_matches_ui(layout, server->ui_state)) {
+                build_layout(layout, server, output);
+            }
+            return &layout;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+const ChromeLayout *chrome_layout_for(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server || !output) {
+        return nullptr;
+    }
+    return find_layout(server, output);
+}
+
+const ChromeLayout *chrome_layout_at(ArolloaServer *server, double lx, double ly) {
+    if (!server) {
+        return nullptr;
+    }
+
+    auto &cache = server->chrome;
+    if (cache.pointer_output) {
+        const ChromeLayout *layout = find_layout(server, cache.pointer_output);
+        if (layout && wlr_box_contains_point(&layout->layout_box, lx, ly)) {
+            return layout;
+        }
+    }
+
+    if (cache.stale) {
+        rebuild_all(server);
+    }
+    for (auto &layout : cache.outputs) {
+        if (wlr_box_contains_point(&layout.layout_box, lx, ly)) {
+            cache.pointer_output = layout.output;
+            return find_layout(server, layout.output);
+        }
+    }
+    return nullptr;
+}
+
+ChromeHit chrome_panel_hit(const ChromeLayout &layout, double local_x) {
+    if (local_x < 0.0) {
+        return {};
+    }
+    const auto column = static_cast<std::size_t>(local_x);
+    if (column >= layout.panel_columns.size()) {
+        return {};
+    }
+    return layout.panel_columns[column];
+}
+
+// Launcher rows are laid out on a virtual strip count * entry_pitch tall
+// that scrolls behind the viewport; drawing and hit-testing both map rows
+// through these helpers.
+double launcher_clamp_scroll(const LauncherGeometry &geometry, std::size_t count, double scroll) {
+    const double content = count > 0 ? (count - 1) * geometry.entry_pitch + geometry.entry_height : 0.0;
+    return std::clamp(scroll, 0.0, std::max(0.0, content - geometry.rows_height));
+}
+
+LauncherRowRange launcher_visible_rows(const LauncherGeometry &geometry, std::size_t count, double scroll) {
+    if (count == 0 || geometry.entry_pitch <= 0.0) {
+        return {};
+    }
+    scroll = launcher_clamp_scroll(geometry, count, scroll);
+    LauncherRowRange range;
+    range.first = std::min(count, static_cast<std::size_t>(scroll / geometry.entry_pitch));
+    range.last = std::min(count, static_cast<std::size_t>(std::ceil((scroll + geometry.rows_height) /
+                                                                    geometry.entry_pitch)));
+    return range;
+}
+
+double launcher_row_y(const LauncherGeometry &geometry, std::size_t count, double scroll, std::size_t row) {
+    return geometry.entry_y + row * geometry.entry_pitch - launcher_clamp_scroll(geometry, count, scroll);
+}
+
+// Returns the row under an output-local point, or -1 for the gaps between
+// cards and anything outside the viewport.
+int launcher_row_at(const LauncherGeometry &geometry, std::size_t count, double scroll, double local_x, double local_y) {
+    const double viewport_y = local_y - geometry.entry_y;
+    if (viewport_y < 0.0 || viewport_y >= geometry.rows_height || local_x < geometry.entry_x ||
+        local_x >= geometry.entry_x + geometry.entry_width || geometry.entry_pitch <= 0.0) {
+        return -1;
+    }
+
+    const double strip_y = viewport_y + launcher_clamp_scroll(geometry, count, scroll);
+    const auto row = static_cast<std::size_t>(strip_y / geometry.entry_pitch);
+    if (row >= count || strip_y - row * geometry.entry_pitch >= geometry.entry_height) {
+        return -1;
+    }
+    return static_cast<int>(row);
+}
+
+namespace {
+// The launcher is drawn on every output; scrolling follows the one the
+// pointer is on.
+const ChromeLayout *launcher_layout(ArolloaServer *server) {
+    const ChromeLayout *layout = chrome_layout_at(server, server->cursor_x, server->cursor_y);
+    if (!layout) {
+        ArolloaOutput *output = nullptr;
+        wl_list_for_each(output, &server->outputs, link) {
+            if ((layout = chrome_layout_for(server, output))) {
+                break;
+            }
+        }
+    }
+    return layout;
+}
+
+void set_scroll_target(ArolloaServer *server, const LauncherGeometry &geometry, double target) {
+    auto &ui = server->ui_state;
+    const auto clamped = static_cast<float>(launcher_clamp_scroll(geometry, ui.launcher_matches.size(), target));
+    if (clamped != ui.launcher_scroll_target) {
+        ui.launcher_scroll_target = clamped;
+        mark_ui_dirty(server);
+    }
+}
+} // namespace
+
+void launcher_scroll_by(ArolloaServer *server, double delta) {
+    if (!server) {
+        return;
+    }
+    if (const ChromeLayout *layout = launcher_layout(server)) {
+        set_scroll_target(server, layout->launcher, server->ui_state.launcher_scroll_target + delta);
+    }
+}
+
+// Scrolls just far enough to bring the highlighted row fully into view.
+void launcher_reveal_highlight(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    const ChromeLayout *layout = launcher_layout(server);
+    if (!layout) {
+        return;
+    }
+
+    const auto &geometry = layout->launcher;
+    const double top = server->ui_state.highlighted_index * geometry.entry_pitch;
+    const double bottom = top + geometry.entry_height;
+    const double current = server->ui_state.launcher_scroll_target;
+    set_scroll_target(server, geometry, std::min(std::max(current, bottom - geometry.rows_height), top));
+}
+
+void chrome_layout_invalidate(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    server->chrome.stale = true;
+    mark_ui_dirty(server);
+}
+
+void chrome_layout_forget(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server) {
+        return;
+    }
+
+    auto &cache = server->chrome;
+    cache.outputs.erase(std::remove_if(cache.outputs.begin(), cache.outputs.end(),
+        [output](const ChromeLayout &layout) {
+            return layout.output == output;
+        }), cache.outputs.end());
+    if (cache.pointer_output == output) {
+        cache.pointer_output = nullptr;
+    }
+    cache.stale = true;
+}
@@ -0,0 +1,125 @@
+#include "../../include/arolloa.h"
+#include <wlr/version.h>
+
+namespace {
+// Server-side unless the user prefers every client to draw its own frame.
+enum wlr_xdg_toplevel_decoration_v1_mode preferred_mode() {
+    return get_config_bool("decorations.server_side", true) ? WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE
+                                                            : WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE;
+}
+
+// The mode goes out with the toplevel's next configure. wlroots 0.18 refuses
+// configures before the client's initial commit; that case is picked up by
+// decoration_initial_commit.
+void apply_mode(struct wlr_xdg_toplevel_decoration_v1 *decoration) {
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    if (!decoration->toplevel->base->initialized) {
+        return;
+    }
+#endif
+    wlr_xdg_toplevel_decoration_v1_set_mode(decoration, preferred_mode());
+}
+
+ArolloaView *view_for_decoration(const struct wlr_xdg_toplevel_decoration_v1 *decoration) {
+    return static_cast<ArolloaView *>(decoration->toplevel->base->data);
+}
+
+// Clients asking for a mode get our policy again; the spec lets the
+// compositor have the last word.
+void handle_request_mode(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaDecoration *deco = wl_container_of(listener, deco, request_mode);
+    apply_mode(deco->decoration);
+}
+
+void handle_destroy(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaDecoration *deco = wl_container_of(listener, deco, destroy);
+    if (ArolloaView *view = view_for_decoration(deco->decoration)) {
+        view->decoration = nullptr;
+        decoration_sync(view);
+    }
+    wl_list_remove(&deco->request_mode.link);
+    wl_list_remove(&deco->destroy.link);
+    free(deco);
+}
+
+void handle_new_decoration(struct wl_listener *listener, void *data) {
+    ArolloaServer *server = wl_container_of(listener, server, new_decoration);
+    auto *decoration = static_cast<struct wlr_xdg_toplevel_decoration_v1 *>(data);
+
+    auto *deco = static_cast<ArolloaDecoration *>(calloc(1, sizeof(ArolloaDecoration)));
+    if (!deco) {
+        return;
+    }
+    deco->decoration = decoration;
+    deco->server = server;
+
+    deco->request_mode.notify = handle_request_mode;
+    wl_signal_add(&decoration->events.request_mode, &deco->request_mode);
+    deco->destroy.notify = handle_destroy;
+    wl_signal_add(&decoration->events.destroy, &deco->destroy);
+
+    if (ArolloaView *view = view_for_decoration(decoration)) {
+        view->decoration = decoration;
+    }
+    apply_mode(decoration);
+}
+} // namespace
+
+void decoration_init(ArolloaServer *server) {
+    if (!server || !server->decoration_manager) {
+        return;
+    }
+
+    server->new_decoration.notify = handle_new_decoration;
+    wl_signal_add(&server->decoration_manager->events.new_toplevel_decoration, &server->new_decoration);
+}
+
+void decoration_finish(ArolloaServer *server) {
+    if (!server || !server->decoration_manager) {
+        return;
+    }
+
+    // Per-toplevel decorations go away with their clients.
+    wl_list_remove(&server->new_decoration.link);
+}
+
+void decoration_initial_commit(ArolloaView *view) {
+    if (view->decoration) {
+        wlr_xdg_toplevel_decoration_v1_set_mode(view->decoration, preferred_mode());
+    }
+}
+
+// Follows the mode the client has acknowledged, not the one we asked for:
+// chrome appears once the client has stopped drawing its own. The frame
+// size changes with it, so tiling refits the window.
+void decoration_sync(ArolloaView *view) {
+    const bool server_decorated =
+        view->decoration && view->decoration->current.mode == WLR_XDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE;
+    if (view->server_decorated == server_decorated) {
+        return;
+    }
+
+    ArolloaServer *server = view->server;
+    const bool visible = view->mapped && !view->hidden && !view->awaiting_layout;
+    if (visible) {
+        mark_region_dirty(server, view_frame_box(view));
+    }
+    view->server_decorated = server_decorated;
+    if (!view->mapped) {
+        return;
+    }
+
+    if (visible) {
+        mark_region_dirty(server, view_frame_box(view));
+    }
+    view_index_update(server, view);
+    render_list_update(view);
+    if (view->output && !view->floating) {
+        view->configured_width = 0;
+        view->configured_height = 0;
+        tiling_mark_output_dirty(server, view->output);
+    }
+    mark_ui_dirty(server);
+}
@@ -0,0 +1,152 @@
+#include "../../include/arolloa.h"
+
+namespace {
+ArolloaOutput *output_for(ArolloaServer *server, const struct wlr_output *wlr_output) {
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        if (output->wlr_output == wlr_output) {
+            return output;
+        }
+    }
+    return nullptr;
+}
+
+// The output a view asked for, else the one holding its centre, else the
+// one under the cursor.
+ArolloaOutput *target_output(ArolloaView *view, const struct wlr_output *requested) {
+    ArolloaServer *server = view->server;
+    if (ArolloaOutput *output = requested ? output_for(server, requested) : nullptr) {
+        return output;
+    }
+    const double centre_x = view->x + view->width / 2.0;
+    const double centre_y = view->y + view->height / 2.0;
+    if (struct wlr_output *under = wlr_output_layout_output_at(server->output_layout, centre_x, centre_y)) {
+        return output_for(server, under);
+    }
+    return output_at_cursor(server);
+}
+
+ArolloaOutput *fullscreen_output_of(ArolloaView *view) {
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &view->server->outputs, link) {
+        if (output->fullscreen_view == view) {
+            return output;
+        }
+    }
+    return nullptr;
+}
+
+// Resizes the view through a layout transaction so the new size and
+// position appear together.
+void resize_to(ArolloaView *view, const struct wlr_box &box) {
+    ArolloaServer *server = view->server;
+    view->configured_width = box.width;
+    view->configured_height = box.height;
+    const uint32_t serial = wlr_xdg_toplevel_set_size(view->xdg_surface->toplevel, box.width, box.height);
+    transaction_add(server, view, box, serial);
+    transaction_commit(server);
+}
+
+void enter(ArolloaView *view, ArolloaOutput *output) {
+    ArolloaServer *server = view->server;
+    struct wlr_box box = {};
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+    if (wlr_box_empty(&box)) {
+        wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, false);
+        return;
+    }
+
+    // One fullscreen view per output; an earlier one steps back.
+    if (ArolloaView *previous = output->fullscreen_view) {
+        view_set_fullscreen(previous, false, nullptr);
+    }
+
+    view->restore_box = {.x = view->x, .y = view->y, .width = view->width, .height = view->height};
+    view->fullscreen = true;
+    output->fullscreen_view = view;
+    tiling_move_view(view, output);
+    wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, true);
+    resize_to(view, box);
+    focus_view(server, view);
+}
+
+void leave(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    if (ArolloaOutput *output = fullscreen_output_of(view)) {
+        output->fullscreen_view = nullptr;
+    }
+    view->fullscreen = false;
+    wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, false);
+
+    // Tiled views get their tile back from the next relayout; floating
+    // ones return to where they were.
+    if (view->output && !view->floating && server->layout_mode != WindowLayout::FLOATING) {
+        view->configured_width = 0;
+        view->configured_height = 0;
+        tiling_mark_output_dirty(server, view->output);
+    } else {
+        resize_to(view, view->restore_box);
+        tiling_move_view(view, frame_output_for(server, view->restore_box));
+    }
+}
+} // namespace
+
+// Enters or leaves fullscreen. Every request is answered with a configure,
+// even when the state does not change.
+void view_set_fullscreen(ArolloaView *view, bool fullscreen, struct wlr_output *wlr_output) {
+    if (!view || !view->mapped || !view->xdg_surface->toplevel) {
+        return;
+    }
+
+    ArolloaServer *server = view->server;
+    if (!fullscreen) {
+        if (view->fullscreen) {
+            leave(view);
+        } else {
+            wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, false);
+        }
+        mark_ui_dirty(server);
+        return;
+    }
+
+    ArolloaOutput *output = target_output(view, wlr_output);
+    if (view->fullscreen && output && output->fullscreen_view == view) {
+        wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, true);
+        return;
+    }
+    if (view->fullscreen) {
+        leave(view);
+    }
+    if (!output) {
+        wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, false);
+        return;
+    }
+    enter(view, output);
+    mark_ui_dirty(server);
+}
+
+// An unmapped view gives up its output without a configure; the client
+// keeps its state and asks again when it maps.
+void fullscreen_view_unmapped(ArolloaView *view) {
+    if (!view->fullscreen) {
+        return;
+    }
+    if (ArolloaOutput *output = fullscreen_output_of(view)) {
+        output->fullscreen_view = nullptr;
+    }
+    view->fullscreen = false;
+}
+
+// Fullscreen views on a disconnected output drop back to windowed.
+void fullscreen_forget_output(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server || !output->fullscreen_view) {
+        return;
+    }
+
+    ArolloaView *view = output->fullscreen_view;
+    output->fullscreen_view = nullptr;
+    view->fullscreen = false;
+    if (view->xdg_surface->toplevel) {
+        wlr_xdg_toplevel_set_fullscreen(view->xdg_surface->toplevel, false);
+    }
+}
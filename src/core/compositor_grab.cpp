@@ -0,0 +1,215 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int MIN_VIEW_SIZE = 64;
+
+const char *resize_cursor_name(uint32_t edges) {
+    const bool top = edges & WLR_EDGE_TOP;
+    const bool bottom = edges & WLR_EDGE_BOTTOM;
+    const bool left = edges & WLR_EDGE_LEFT;
+    const bool right = edges & WLR_EDGE_RIGHT;
+    if (top && left) {
+        return "top_left_corner";
+    }
+    if (top && right) {
+        return "top_right_corner";
+    }
+    if (bottom && left) {
+        return "bottom_left_corner";
+    }
+    if (bottom && right) {
+        return "bottom_right_corner";
+    }
+    if (top) {
+        return "top_side";
+    }
+    if (bottom) {
+        return "bottom_side";
+    }
+    if (left) {
+        return "left_side";
+    }
+    return "right_side";
+}
+
+void set_grab_cursor(ArolloaServer *server, const char *name, const char *fallback) {
+    if (!server->cursor || !server->cursor_mgr) {
+        return;
+    }
+    if (!wlr_xcursor_manager_get_xcursor(server->cursor_mgr, name, 1.0f)) {
+        name = fallback;
+    }
+    wlr_cursor_set_xcursor(server->cursor, server->cursor_mgr, name);
+}
+
+// Serials wrap; anything at or after the pending one acknowledges it.
+bool serial_reached(uint32_t current, uint32_t pending) {
+    return static_cast<int32_t>(current - pending) >= 0;
+}
+
+// Only one resize configure is in flight at a time. Pointer motion that
+// arrives meanwhile just updates the wanted size, which is sent once the
+// client has caught up, so slow clients are never buried in configures.
+void send_resize_configure(CursorGrab &grab) {
+    struct wlr_xdg_toplevel *toplevel = grab.view->xdg_surface->toplevel;
+    if (!toplevel || (grab.wanted_width == grab.sent_width && grab.wanted_height == grab.sent_height)) {
+        return;
+    }
+    grab.sent_width = grab.wanted_width;
+    grab.sent_height = grab.wanted_height;
+    grab.configure_serial = wlr_xdg_toplevel_set_size(toplevel, grab.wanted_width, grab.wanted_height);
+}
+
+void process_move(ArolloaServer *server, CursorGrab &grab) {
+    ArolloaView *view = grab.view;
+    const int x = grab.start_box.x + static_cast<int>(std::lround(server->cursor_x - grab.start_x));
+    const int y = grab.start_box.y + static_cast<int>(std::lround(server->cursor_y - grab.start_y));
+    if (x == view->x && y == view->y) {
+        return;
+    }
+
+    // The area the window left and the area it now covers are damaged; only
+    // those parts of the screen and of the overlay, which carries the window
+    // frame, are redrawn.
+    mark_region_dirty(server, view_frame_box(view));
+    view->x = x;
+    view->y = y;
+    mark_region_dirty(server, view_frame_box(view));
+    view_index_update(server, view);
+    render_list_update(view);
+}
+
+void process_resize(ArolloaServer *server, CursorGrab &grab) {
+    const int dx = static_cast<int>(std::lround(server->cursor_x - grab.start_x));
+    const int dy = static_cast<int>(std::lround(server->cursor_y - grab.start_y));
+
+    int width = grab.start_box.width;
+    int height = grab.start_box.height;
+    if (grab.edges & WLR_EDGE_RIGHT) {
+        width += dx;
+    } else if (grab.edges & WLR_EDGE_LEFT) {
+        width -= dx;
+    }
+    if (grab.edges & WLR_EDGE_BOTTOM) {
+        height += dy;
+    } else if (grab.edges & WLR_EDGE_TOP) {
+        height -= dy;
+    }
+
+    grab.wanted_width = std::max(width, MIN_VIEW_SIZE);
+    grab.wanted_height = std::max(height, MIN_VIEW_SIZE);
+    if (grab.configure_serial == 0) {
+        send_resize_configure(grab);
+    }
+}
+} // namespace
+
+void begin_interactive(ArolloaView *view, GrabMode mode, uint32_t edges) {
+    if (!view || mode == GrabMode::NONE) {
+        return;
+    }
+
+    ArolloaServer *server = view->server;
+    focus_view(server, view);
+    tiling_float_view(view);
+
+    auto &grab = server->grab;
+    grab = {};
+    grab.mode = mode;
+    grab.view = view;
+    grab.start_x = server->cursor_x;
+    grab.start_y = server->cursor_y;
+    grab.start_box = {.x = view->x, .y = view->y, .width = view->width, .height = view->height};
+    grab.edges = edges;
+    grab.sent_width = view->width;
+    grab.sent_height = view->height;
+
+    if (mode == GrabMode::RESIZE) {
+        wlr_xdg_toplevel_set_resizing(view->xdg_surface->toplevel, true);
+        set_grab_cursor(server, resize_cursor_name(edges), "left_ptr");
+    } else {
+        set_grab_cursor(server, "grabbing", "fleur");
+    }
+}
+
+// Applies coalesced pointer motion to the active grab. Returns false when no
+// grab is active and the pointer should be handled normally.
+bool grab_process_motion(ArolloaServer *server) {
+    if (!server) {
+        return false;
+    }
+
+    auto &grab = server->grab;
+    switch (grab.mode) {
+        case GrabMode::MOVE:
+            process_move(server, grab);
+            return true;
+        case GrabMode::RESIZE:
+            process_resize(server, grab);
+            return true;
+        case GrabMode::NONE:
+            break;
+    }
+    return false;
+}
+
+// A resize that is still waiting for its last configure keeps its anchor
+// after the button is released, so the final size lands in the right place.
+void grab_end(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &grab = server->grab;
+    if (grab.mode == GrabMode::NONE) {
+        return;
+    }
+
+    if (grab.mode == GrabMode::RESIZE && grab.view->xdg_surface->toplevel) {
+        wlr_xdg_toplevel_set_resizing(grab.view->xdg_surface->toplevel, false);
+    }
+    // A moved window belongs to the output now showing most of it.
+    if (grab.mode == GrabMode::MOVE) {
+        tiling_move_view(grab.view, frame_output_for(server, view_frame_box(grab.view)));
+    }
+    const bool settling = grab.mode == GrabMode::RESIZE && grab.configure_serial != 0;
+    grab.mode = GrabMode::NONE;
+    if (!settling) {
+        grab = {};
+    }
+
+    ensure_default_cursor(server);
+    cursor_rebase(server);
+}
+
+void grab_handle_commit(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    auto &grab = server->grab;
+    if (grab.view != view || grab.configure_serial == 0) {
+        return;
+    }
+
+    // Left and top edges stay anchored to where the opposite edge was.
+    const struct wlr_surface *surface = view->xdg_surface->surface;
+    if (grab.edges & WLR_EDGE_LEFT) {
+        view->x = grab.start_box.x + grab.start_box.width - surface->current.width;
+    }
+    if (grab.edges & WLR_EDGE_TOP) {
+        view->y = grab.start_box.y + grab.start_box.height - surface->current.height;
+    }
+
+    if (!serial_reached(view->xdg_surface->current.configure_serial, grab.configure_serial)) {
+        return;
+    }
+    grab.configure_serial = 0;
+
+    // A released grab still sends the last size the pointer asked for, and
+    // settles once the client has drawn it.
+    send_resize_configure(grab);
+    if (grab.mode == GrabMode::NONE && grab.configure_serial == 0) {
+        grab = {};
+    }
+}
@@ -4,7 +4,7 @@
 #include <chrono>
 #include <cstdlib>
 #include <cmath>
-#include <thread>
+#include <ctime>
 
 #include <wlr/version.h>
 
@@ -13,81 +13,23 @@
 namespace {
 using namespace std::chrono_literals;
 
+// Wheel steps report 15 units; three of them scroll about two launcher rows.
+constexpr double LAUNCHER_SCROLL_SCALE = 3.0;
 
-void show_system_notification(ArolloaServer *server, const std::string &title, const std::string &body);
-void show_volume_change(ArolloaServer *server, int level);
 void mark_last_interaction(ArolloaServer *server) {
     if (!server) {
         return;
     }
     server->ui_state.last_interaction = std::chrono::steady_clock::now();
+    mark_ui_dirty(server);
 }
 
-void spawn_command_async(const std::string &command) {
-    if (command.empty()) {
-        return;
-    }
-
-    std::thread([command]() {
-        std::string wrapped = command;
-        if (!wrapped.empty() && wrapped.back() != '&') {
-            wrapped += " &";
-        }
-        std::system(wrapped.c_str());
-    }).detach();
-}
-
-bool pointer_in_panel(const ArolloaServer *server) {
-    return server && server->cursor_y <= static_cast<double>(SwissDesign::PANEL_HEIGHT);
-}
-
-void update_pointer_hover_state(ArolloaServer *server) {
+bool pointer_in_panel(ArolloaServer *server) {
     if (!server) {
-        return;
-    }
-
-    server->ui_state.menu_hovered = false;
-    server->ui_state.hovered_panel_index = -1;
-    server->ui_state.hovered_tray_index = -1;
-
-    if (!pointer_in_panel(server)) {
-        return;
-    }
-
-    server->ui_state.menu_hovered = server->cursor_x <= FOREST_PANEL_MENU_WIDTH;
-
-    const double icon_size = 28.0;
-    const double spacing = 12.0;
-    double local_x = server->cursor_x - FOREST_PANEL_MENU_WIDTH - spacing;
-    for (std::size_t index = 0; index < server->ui_state.panel_apps.size(); ++index) {
-        if (local_x >= 0.0 && local_x <= icon_size) {
-            server->ui_state.hovered_panel_index = static_cast<int>(index);
-            break;
-        }
-        local_x -= icon_size + spacing;
-    }
-
-    int width = 0;
-    int height = 0;
-    if (auto *output = wlr_output_layout_output_at(server->output_layout, server->cursor_x, server->cursor_y)) {
-        wlr_output_effective_resolution(output, &width, &height);
-    }
-
-    if (width <= 0) {
-        return;
-    }
-
-    const double tray_icon = 22.0;
-    const double tray_spacing = 18.0;
-    double anchor = static_cast<double>(width) - 16.0;
-    for (int index = static_cast<int>(server->ui_state.tray_icons.size()) - 1; index >= 0; --index) {
-        anchor -= tray_icon;
-        if (server->cursor_x >= anchor && server->cursor_x <= anchor + tray_icon) {
-            server->ui_state.hovered_tray_index = index;
-            break;
-        }
-        anchor -= tray_spacing;
+        return false;
     }
+    const ChromeLayout *layout = chrome_layout_at(server, server->cursor_x, server->cursor_y);
+    return layout && server->cursor_y - layout->layout_box.y <= static_cast<double>(SwissDesign::PANEL_HEIGHT);
 }
 
 void remove_listener_safe(struct wl_listener *listener) {
@@ -106,40 +48,20 @@ bool handle_launcher_click(ArolloaServer *server, const wlr_pointer_button_event
         return false;
     }
 
-    struct wlr_output *output = wlr_output_layout_output_at(server->output_layout, server->cursor_x, server->cursor_y);
-    if (!output) {
-        server->ui_state.launcher_visible = false;
-        mark_last_interaction(server);
-        return true;
-    }
-
-    int width = 0;
-    int height = 0;
-    wlr_output_effective_resolution(output, &width, &height);
-
-    const double launcher_width = FOREST_LAUNCHER_WIDTH;
-    const double launcher_height = std::min<double>(height * 0.6,
-        std::max<double>(SwissDesign::PANEL_HEIGHT * 4.0,
-            server->ui_state.launcher_entries.size() * FOREST_LAUNCHER_ENTRY_HEIGHT + 96.0));
-
-    const double start_x = (width - launcher_width) / 2.0;
-    const double start_y = (height - launcher_height) / 2.0;
-    const double local_x = server->cursor_x - start_x;
-    const double local_y = server->cursor_y - start_y;
-
-    if (local_x < 0.0 || local_y < 0.0 || local_x > launcher_width || local_y > launcher_height) {
+    const ChromeLayout *layout = chrome_layout_at(server, server->cursor_x, server->cursor_y);
+    const double local_x = layout ? server->cursor_x - layout->layout_box.x : 0.0;
+    const double local_y = layout ? server->cursor_y - layout->layout_box.y : 0.0;
+    if (!layout || !layout->launcher.panel.contains(local_x, local_y)) {
         server->ui_state.launcher_visible = false;
         mark_last_interaction(server);
         return true;
     }
 
-    if (local_y < 72.0) {
-        return true;
-    }
-
-    const std::size_t index = static_cast<std::size_t>((local_y - 72.0) / FOREST_LAUNCHER_ENTRY_HEIGHT);
-    if (index < server->ui_state.launcher_entries.size()) {
-        server->ui_state.highlighted_index = index;
+    // Clicks in the gap between two cards select nothing.
+    const int row = launcher_row_at(layout->launcher, server->ui_state.launcher_matches.size(),
+                                    server->ui_state.launcher_scroll, local_x, local_y);
+    if (row >= 0) {
+        server->ui_state.highlighted_index = static_cast<std::size_t>(row);
         mark_last_interaction(server);
         activate_launcher_selection(server);
     }
@@ -166,11 +88,18 @@ bool handle_panel_click(ArolloaServer *server, const wlr_pointer_button_event *e
     const int hovered = server->ui_state.hovered_panel_index;
     if (hovered >= 0 && hovered < static_cast<int>(server->ui_state.panel_apps.size())) {
         const auto &app = server->ui_state.panel_apps[static_cast<std::size_t>(hovered)];
-        spawn_command_async(app.command);
+        launch_application(server, app.name, app.command);
         show_system_notification(server, "Launching", app.name);
         return true;
     }
 
+    const int tray = server->ui_state.hovered_tray_index;
+    if (tray >= 0 && tray < static_cast<int>(server->ui_state.tray_icons.size()) &&
+        server->ui_state.tray_icons[static_cast<std::size_t>(tray)].label == "PWR") {
+        toggle_low_power_mode(server);
+        return true;
+    }
+
     return true;
 }
 
@@ -181,70 +110,43 @@ void keyboard_handle_modifiers(struct wl_listener *listener, void *data) {
     struct wlr_keyboard *wlr_keyboard = wlr_keyboard_from_input_device(keyboard->device);
     wlr_seat_set_keyboard(keyboard->server->seat, wlr_keyboard);
     wlr_seat_keyboard_notify_modifiers(keyboard->server->seat, &wlr_keyboard->modifiers);
+
+    // Letting go of Alt picks the highlighted window.
+    if (keyboard->server->switcher.active && !(wlr_keyboard_get_modifiers(wlr_keyboard) & WLR_MODIFIER_ALT)) {
+        switcher_commit(keyboard->server);
+    }
 }
 
 void keyboard_handle_key(struct wl_listener *listener, void *data) {
     ArolloaKeyboard *keyboard = wl_container_of(listener, keyboard, key);
     ArolloaServer *server = keyboard->server;
     auto *event = static_cast<struct wlr_keyboard_key_event *>(data);
-    struct wlr_seat *seat = server->seat;
-
     struct wlr_keyboard *wlr_keyboard = wlr_keyboard_from_input_device(keyboard->device);
+    if (event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
+        latency_trace_input(server, LatencySource::KEY, event->time_msec, server->seat->keyboard_state.focused_surface);
+    }
 
-    const uint32_t keycode = event->keycode + 8;
-    const xkb_keysym_t *syms = nullptr;
-    const int nsyms = xkb_state_key_get_syms(wlr_keyboard->xkb_state, keycode, &syms);
-
-    bool handled = false;
-    const uint32_t modifiers = wlr_keyboard_get_modifiers(wlr_keyboard);
-    if ((modifiers & WLR_MODIFIER_ALT) && event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
-        for (int i = 0; i < nsyms; ++i) {
-            if (syms[i] == XKB_KEY_F4) {
-                wl_display_terminate(server->wl_display);
-                handled = true;
-                break;
-            }
-        }
+    if (!keybindings_handle_key(server, wlr_keyboard, event)) {
+        wlr_seat_set_keyboard(server->seat, wlr_keyboard);
+        wlr_seat_keyboard_notify_key(server->seat, event->time_msec, event->keycode, event->state);
     }
+}
 
-    if (!handled && event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
-        for (int i = 0; i < nsyms; ++i) {
-            const xkb_keysym_t sym = syms[i];
-            if ((modifiers & WLR_MODIFIER_LOGO) && sym == XKB_KEY_space) {
-                toggle_launcher(server);
-                mark_last_interaction(server);
-                handled = true;
-                break;
-            }
+// High-rate pointers deliver many motion events per output frame. Clients
+// still receive every event, relative to the surface focused at the last
+// flush; hover, focus and UI invalidation wait for the pointer frame.
+void queue_pointer_motion(ArolloaServer *server, uint32_t time_msec) {
+    server->cursor_x = server->cursor->x;
+    server->cursor_y = server->cursor->y;
 
-            if (server->ui_state.launcher_visible) {
-                if (sym == XKB_KEY_Escape) {
-                    server->ui_state.launcher_visible = false;
-                    mark_last_interaction(server);
-                    handled = true;
-                    break;
-                }
-                if (sym == XKB_KEY_Return || sym == XKB_KEY_KP_Enter) {
-                    handled = activate_launcher_selection(server);
-                    break;
-                }
-                if (sym == XKB_KEY_Up) {
-                    focus_launcher_offset(server, -1);
-                    handled = true;
-                    break;
-                }
-                if (sym == XKB_KEY_Down) {
-                    focus_launcher_offset(server, 1);
-                    handled = true;
-                    break;
-                }
-            }
-        }
-    }
+    latency_trace_input(server, LatencySource::POINTER_MOTION, time_msec, server->seat->pointer_state.focused_surface);
 
-    if (!handled) {
-        wlr_seat_set_keyboard(seat, wlr_keyboard);
-        wlr_seat_keyboard_notify_key(seat, event->time_msec, event->keycode, event->state);
+    auto &motion = server->pointer_motion;
+    motion.pending = true;
+    motion.time_msec = time_msec;
+    if (server->grab.mode == GrabMode::NONE && server->seat->pointer_state.focused_surface) {
+        wlr_seat_pointer_notify_motion(server->seat, time_msec, server->cursor_x - motion.focus_origin_x,
+                                       server->cursor_y - motion.focus_origin_y);
     }
 }
 
@@ -256,11 +158,7 @@ void cursor_handle_motion(struct wl_listener *listener, void *data) {
         device = &event->pointer->base;
     }
     wlr_cursor_move(server->cursor, device, event->delta_x, event->delta_y);
-    server->cursor_x = server->cursor->x;
-    server->cursor_y = server->cursor->y;
-    mark_last_interaction(server);
-    update_pointer_hover_state(server);
-    wlr_seat_pointer_notify_motion(server->seat, event->time_msec, server->cursor_x, server->cursor_y);
+    queue_pointer_motion(server, event->time_msec);
 }
 
 void cursor_handle_motion_absolute(struct wl_listener *listener, void *data) {
@@ -271,19 +169,59 @@ void cursor_handle_motion_absolute(struct wl_listener *listener, void *data) {
         device = &event->pointer->base;
     }
     wlr_cursor_warp_absolute(server->cursor, device, event->x, event->y);
-    server->cursor_x = server->cursor->x;
-    server->cursor_y = server->cursor->y;
-    mark_last_interaction(server);
-    update_pointer_hover_state(server);
-    wlr_seat_pointer_notify_motion(server->seat, event->time_msec, server->cursor_x, server->cursor_y);
+    queue_pointer_motion(server, event->time_msec);
+}
+
+// Titlebar drags move the window; the close control asks the client to
+// close. Neither press reaches the client.
+bool handle_decoration_click(ArolloaServer *server, const wlr_pointer_button_event *event) {
+    if (event->state != WLR_BUTTON_PRESSED || event->button != BTN_LEFT) {
+        return false;
+    }
+
+    DecorationHit hit = DecorationHit::NONE;
+    ArolloaView *view = view_decoration_at(server, server->cursor_x, server->cursor_y, &hit);
+    if (!view) {
+        return false;
+    }
+    if (hit == DecorationHit::CLOSE) {
+        wlr_xdg_toplevel_send_close(view->xdg_surface->toplevel);
+    } else {
+        begin_interactive(view, GrabMode::MOVE, WLR_EDGE_NONE);
+        server->grab.forward_release = false;
+    }
+    return true;
 }
 
 void cursor_handle_button(struct wl_listener *listener, void *data) {
     ArolloaServer *server = wl_container_of(listener, server, cursor_button);
     auto *event = static_cast<struct wlr_pointer_button_event *>(data);
+    flush_pointer_motion(server);
+    if (event->state == WLR_BUTTON_PRESSED) {
+        latency_trace_input(server, LatencySource::POINTER_BUTTON, event->time_msec,
+                            server->seat->pointer_state.focused_surface);
+    }
 
-    bool handled = handle_panel_click(server, event);
+    // The client saw the press that started the grab, so it gets the release too.
+    if (server->grab.mode != GrabMode::NONE) {
+        if (server->grab.forward_release) {
+            wlr_seat_pointer_notify_button(server->seat, event->time_msec, event->button, event->state);
+        }
+        if (event->state == WLR_BUTTON_RELEASED) {
+            grab_end(server);
+        }
+        return;
+    }
+
+    bool handled = overview_handle_click(server, event) || handle_panel_click(server, event);
     handled = handle_launcher_click(server, event) || handled;
+    handled = handled || handle_decoration_click(server, event);
+
+    if (!handled && event->state == WLR_BUTTON_PRESSED) {
+        if (ArolloaView *view = view_at(server, server->cursor_x, server->cursor_y, nullptr, nullptr, nullptr)) {
+            focus_view(server, view);
+        }
+    }
 
     if (!handled) {
         wlr_seat_pointer_notify_button(server->seat, event->time_msec, event->button, event->state);
@@ -294,6 +232,19 @@ void cursor_handle_button(struct wl_listener *listener, void *data) {
 void cursor_handle_axis(struct wl_listener *listener, void *data) {
     ArolloaServer *server = wl_container_of(listener, server, cursor_axis);
     auto *event = static_cast<struct wlr_pointer_axis_event *>(data);
+    flush_pointer_motion(server);
+    if (server->ui_state.launcher_visible) {
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+        const bool vertical = event->orientation == WL_POINTER_AXIS_VERTICAL_SCROLL;
+#else
+        const bool vertical = event->orientation == WLR_AXIS_ORIENTATION_VERTICAL;
+#endif
+        if (vertical) {
+            launcher_scroll_by(server, event->delta * LAUNCHER_SCROLL_SCALE);
+        }
+        mark_last_interaction(server);
+        return;
+    }
 #if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
     wlr_seat_pointer_notify_axis(server->seat, event->time_msec, event->orientation, event->delta,
                                  event->delta_discrete, event->source, event->relative_direction);
@@ -322,6 +273,148 @@ void cursor_handle_axis(struct wl_listener *listener, void *data) {
     mark_last_interaction(server);
 }
 
+void cursor_handle_frame(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaServer *server = wl_container_of(listener, server, cursor_frame);
+    flush_pointer_motion(server);
+    wlr_seat_pointer_notify_frame(server->seat);
+}
+
+void seat_handle_request_cursor(struct wl_listener *listener, void *data) {
+    ArolloaServer *server = wl_container_of(listener, server, request_cursor);
+    auto *event = static_cast<struct wlr_seat_pointer_request_set_cursor_event *>(data);
+
+    if (event->seat_client == server->seat->pointer_state.focused_client) {
+        wlr_cursor_set_surface(server->cursor, event->surface, event->hotspot_x, event->hotspot_y);
+    }
+}
+
+void output_layout_handle_change(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaServer *server = wl_container_of(listener, server, output_layout_change);
+    chrome_layout_invalidate(server);
+    tiling_outputs_changed(server);
+    render_list_outputs_changed(server);
+    update_pointer_hover_state(server);
+}
+
+void seat_handle_set_selection(struct wl_listener *listener, void *data) {
+    ArolloaServer *server = wl_container_of(listener, server, request_set_selection);
+    auto *event = static_cast<struct wlr_seat_request_set_selection_event *>(data);
+    wlr_seat_set_selection(server->seat, event->source, event->serial);
+}
+
+} // namespace
+
+void update_pointer_hover_state(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    server->ui_state.menu_hovered = false;
+    server->ui_state.hovered_panel_index = -1;
+    server->ui_state.hovered_tray_index = -1;
+
+    const ChromeLayout *layout = chrome_layout_at(server, server->cursor_x, server->cursor_y);
+    if (!layout || server->cursor_y - layout->layout_box.y > static_cast<double>(SwissDesign::PANEL_HEIGHT)) {
+        return;
+    }
+
+    const ChromeHit hit = chrome_panel_hit(*layout, server->cursor_x - layout->layout_box.x);
+    switch (hit.target) {
+        case ChromeTarget::MENU:
+            server->ui_state.menu_hovered = true;
+            break;
+        case ChromeTarget::PANEL_APP:
+            server->ui_state.hovered_panel_index = hit.index;
+            break;
+        case ChromeTarget::TRAY_ICON:
+            server->ui_state.hovered_tray_index = hit.index;
+            break;
+        case ChromeTarget::NONE:
+            break;
+    }
+}
+
+void update_pointer_focus(ArolloaServer *server, uint32_t time_msec) {
+    if (!server || !server->seat) {
+        return;
+    }
+
+    struct wlr_seat *seat = server->seat;
+    const bool had_focus = seat->pointer_state.focused_surface != nullptr;
+
+    // Compositor chrome sits above client surfaces and owns the pointer.
+    if (pointer_in_panel(server) || server->ui_state.launcher_visible) {
+        if (had_focus) {
+            wlr_seat_pointer_clear_focus(seat);
+            ensure_default_cursor(server);
+        }
+        return;
+    }
+
+    struct wlr_surface *surface = nullptr;
+    double sx = 0.0;
+    double sy = 0.0;
+    if (!view_at(server, server->cursor_x, server->cursor_y, &surface, &sx, &sy)) {
+        if (had_focus) {
+            wlr_seat_pointer_clear_focus(seat);
+            ensure_default_cursor(server);
+        }
+        return;
+    }
+
+    // Queued motion already reached the client with these coordinates unless
+    // the focused surface or its position changed.
+    auto &motion = server->pointer_motion;
+    const double origin_x = server->cursor_x - sx;
+    const double origin_y = server->cursor_y - sy;
+    const bool unchanged = seat->pointer_state.focused_surface == surface && motion.focus_origin_x == origin_x &&
+                           motion.focus_origin_y == origin_y;
+    motion.focus_origin_x = origin_x;
+    motion.focus_origin_y = origin_y;
+    if (unchanged) {
+        return;
+    }
+
+    // wlroots only sends enter/leave when the focused surface changes.
+    wlr_seat_pointer_notify_enter(seat, surface, sx, sy);
+    wlr_seat_pointer_notify_motion(seat, time_msec, sx, sy);
+}
+
+// Applies the pointer motion accumulated since the last flush: one hover
+// and focus evaluation, and a redraw only if the hovered target changed.
+void flush_pointer_motion(ArolloaServer *server) {
+    if (!server || !server->pointer_motion.pending) {
+        return;
+    }
+    server->pointer_motion.pending = false;
+    server->ui_state.last_interaction = std::chrono::steady_clock::now();
+    if (grab_process_motion(server)) {
+        return;
+    }
+
+    const auto &ui = server->ui_state;
+    const bool menu_hovered = ui.menu_hovered;
+    const int panel_index = ui.hovered_panel_index;
+    const int tray_index = ui.hovered_tray_index;
+    update_pointer_hover_state(server);
+    if (ui.menu_hovered != menu_hovered || ui.hovered_panel_index != panel_index ||
+        ui.hovered_tray_index != tray_index) {
+        mark_ui_dirty(server);
+    }
+
+    update_pointer_focus(server, server->pointer_motion.time_msec);
+}
+
+// Re-evaluates pointer focus after the scene changed under a stationary
+// pointer (map, unmap, raise, move).
+void cursor_rebase(ArolloaServer *server) {
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    update_pointer_focus(server, static_cast<uint32_t>(now.tv_sec * 1000 + now.tv_nsec / 1000000));
+}
+
 void show_system_notification(ArolloaServer *server, const std::string &title, const std::string &body) {
     if (!server) {
         return;
@@ -342,6 +435,7 @@ void show_system_notification(ArolloaServer *server, const std::string &title, c
     if (server->ui_state.notifications.size() > 6) {
         server->ui_state.notifications.erase(server->ui_state.notifications.begin());
     }
+    mark_ui_dirty(server);
 }
 
 void show_volume_change(ArolloaServer *server, int level) {
@@ -353,6 +447,7 @@ void show_volume_change(ArolloaServer *server, int level) {
     server->ui_state.volume_feedback.level = level;
     server->ui_state.volume_feedback.target_visibility = server->ui_state.notifications_enabled ? 1.0f : 0.0f;
     server->ui_state.volume_feedback.last_update = std::chrono::steady_clock::now();
+    mark_ui_dirty(server);
 
     if (!server->ui_state.notifications_enabled) {
         return;
@@ -376,29 +471,6 @@ void show_volume_change(ArolloaServer *server, int level) {
     server->ui_state.notifications.emplace_back(std::move(notification));
 }
 
-void cursor_handle_frame(struct wl_listener *listener, void *data) {
-    (void)data;
-    ArolloaServer *server = wl_container_of(listener, server, cursor_frame);
-    wlr_seat_pointer_notify_frame(server->seat);
-}
-
-void seat_handle_request_cursor(struct wl_listener *listener, void *data) {
-    ArolloaServer *server = wl_container_of(listener, server, request_cursor);
-    auto *event = static_cast<struct wlr_seat_pointer_request_set_cursor_event *>(data);
-
-    if (event->seat_client == server->seat->pointer_state.focused_client) {
-        wlr_cursor_set_surface(server->cursor, event->surface, event->hotspot_x, event->hotspot_y);
-    }
-}
-
-void seat_handle_set_selection(struct wl_listener *listener, void *data) {
-    ArolloaServer *server = wl_container_of(listener, server, request_set_selection);
-    auto *event = static_cast<struct wlr_seat_request_set_selection_event *>(data);
-    wlr_seat_set_selection(server->seat, event->source, event->serial);
-}
-
-} // namespace
-
 void ensure_default_cursor(ArolloaServer *server) {
     if (!server || !server->cursor) {
         return;
@@ -425,34 +497,45 @@ void toggle_launcher(ArolloaServer *server) {
     }
 
     server->ui_state.launcher_visible = !server->ui_state.launcher_visible;
-    if (server->ui_state.highlighted_index >= server->ui_state.launcher_entries.size()) {
+    if (server->ui_state.launcher_visible) {
+        launcher_search_clear(server);
+        server->ui_state.launcher_scroll = 0.0f;
+        server->ui_state.launcher_scroll_target = 0.0f;
+    }
+    if (server->ui_state.highlighted_index >= server->ui_state.launcher_matches.size()) {
         server->ui_state.highlighted_index = 0;
     }
     mark_last_interaction(server);
 }
 
 void focus_launcher_offset(ArolloaServer *server, int offset) {
-    if (!server || server->ui_state.launcher_entries.empty()) {
+    if (!server || server->ui_state.launcher_matches.empty()) {
         return;
     }
 
-    const int count = static_cast<int>(server->ui_state.launcher_entries.size());
+    const int count = static_cast<int>(server->ui_state.launcher_matches.size());
     int index = static_cast<int>(server->ui_state.highlighted_index);
     index = (index + offset) % count;
     if (index < 0) {
         index += count;
     }
     server->ui_state.highlighted_index = static_cast<std::size_t>(index);
+    launcher_reveal_highlight(server);
     mark_last_interaction(server);
 }
 
 bool activate_launcher_selection(ArolloaServer *server) {
-    if (!server || server->ui_state.launcher_entries.empty()) {
+    if (!server) {
+        return false;
+    }
+
+    const auto &ui = server->ui_state;
+    if (ui.highlighted_index >= ui.launcher_matches.size()) {
         return false;
     }
 
-    const auto &entry = server->ui_state.launcher_entries[server->ui_state.highlighted_index];
-    spawn_command_async(entry.command);
+    const auto &entry = ui.launcher_entries[ui.launcher_matches[ui.highlighted_index]];
+    launch_application(server, entry.name, entry.command);
     show_system_notification(server, "Launching", entry.name);
     server->ui_state.launcher_visible = false;
     mark_last_interaction(server);
@@ -484,6 +567,11 @@ void setup_pointer_interactions(ArolloaServer *server) {
 
     server->request_set_selection.notify = seat_handle_set_selection;
     wl_signal_add(&server->seat->events.request_set_selection, &server->request_set_selection);
+
+    if (server->output_layout) {
+        server->output_layout_change.notify = output_layout_handle_change;
+        wl_signal_add(&server->output_layout->events.change, &server->output_layout_change);
+    }
 }
 
 void teardown_pointer_interactions(ArolloaServer *server) {
@@ -498,6 +586,7 @@ void teardown_pointer_interactions(ArolloaServer *server) {
     remove_listener_safe(&server->cursor_frame);
     remove_listener_safe(&server->request_cursor);
     remove_listener_safe(&server->request_set_selection);
+    remove_listener_safe(&server->output_layout_change);
 }
 
 void server_new_input(struct wl_listener *listener, void *data) {
@@ -523,12 +612,9 @@ void server_new_input(struct wl_listener *listener, void *data) {
             rules.variant = getenv("XKB_DEFAULT_VARIANT");
             rules.options = getenv("XKB_DEFAULT_OPTIONS");
 
-            struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-            struct xkb_keymap *keymap = xkb_map_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
-
-            wlr_keyboard_set_keymap(wlr_keyboard, keymap);
-            xkb_keymap_unref(keymap);
-            xkb_context_unref(context);
+            if (struct xkb_keymap *keymap = keymap_cache_get(server, rules)) {
+                wlr_keyboard_set_keymap(wlr_keyboard, keymap);
+            }
             wlr_keyboard_set_repeat_info(wlr_keyboard, 25, 600);
 
             keyboard->modifiers.notify = keyboard_handle_modifiers;
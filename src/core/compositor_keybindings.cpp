@@ -0,0 +1,529 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <sstream>
+#include <strings.h>
+
+namespace {
+// Lock modifiers (Caps, Num) never take part in matching.
+constexpr uint32_t BINDING_MODIFIERS = WLR_MODIFIER_SHIFT | WLR_MODIFIER_CTRL | WLR_MODIFIER_ALT | WLR_MODIFIER_LOGO;
+
+struct DefaultBinding {
+    const char *key;   // Same form as the part after "bind." in the config
+    const char *value;
+};
+
+// Built-in shortcuts; config entries with the same key replace them and
+// the action "none" removes one.
+constexpr DefaultBinding DEFAULT_BINDINGS[] = {
+    {"Alt+F4", "exit"},
+    {"Super+space", "toggle_launcher"},
+    {"Super+p", "toggle_low_power"},
+    {"Super+Tab", "toggle_overview"},
+    {"Alt+Tab", "switcher_next"},
+    {"Alt+Shift+Tab", "switcher_prev"},
+    {"switcher.Alt+Escape", "switcher_cancel"},
+    {"launcher.Escape", "launcher_close"},
+    {"launcher.Return", "launcher_activate"},
+    {"launcher.KP_Enter", "launcher_activate"},
+    {"launcher.BackSpace", "launcher_erase"},
+    {"launcher.Up", "launcher_prev"},
+    {"launcher.Down", "launcher_next"},
+    {"Super+1", "workspace 1"},
+    {"Super+2", "workspace 2"},
+    {"Super+3", "workspace 3"},
+    {"Super+4", "workspace 4"},
+    {"Super+Shift+1", "move_to_workspace 1"},
+    {"Super+Shift+2", "move_to_workspace 2"},
+    {"Super+Shift+3", "move_to_workspace 3"},
+    {"Super+Shift+4", "move_to_workspace 4"},
+};
+
+struct ActionName {
+    const char *name;
+    BindingAction action;
+    bool repeats;
+};
+
+constexpr ActionName ACTIONS[] = {
+    {"none", BindingAction::NONE, false},
+    {"spawn", BindingAction::SPAWN, false},
+    {"exit", BindingAction::EXIT, false},
+    {"toggle_launcher", BindingAction::TOGGLE_LAUNCHER, false},
+    {"launcher_close", BindingAction::LAUNCHER_CLOSE, false},
+    {"launcher_next", BindingAction::LAUNCHER_NEXT, true},
+    {"launcher_prev", BindingAction::LAUNCHER_PREV, true},
+    {"launcher_activate", BindingAction::LAUNCHER_ACTIVATE, false},
+    {"launcher_erase", BindingAction::LAUNCHER_ERASE, true},
+    {"focus_next", BindingAction::FOCUS_NEXT, false},
+    {"move", BindingAction::MOVE, true},
+    {"layout", BindingAction::LAYOUT, false},
+    {"cycle_layout", BindingAction::CYCLE_LAYOUT, false},
+    {"toggle_low_power", BindingAction::TOGGLE_LOW_POWER, false},
+    {"workspace", BindingAction::WORKSPACE, false},
+    {"move_to_workspace", BindingAction::MOVE_TO_WORKSPACE, false},
+    {"toggle_overview", BindingAction::TOGGLE_OVERVIEW, false},
+    {"switcher_next", BindingAction::SWITCHER_NEXT, true},
+    {"switcher_prev", BindingAction::SWITCHER_PREV, true},
+    {"switcher_cancel", BindingAction::SWITCHER_CANCEL, false},
+};
+
+uint64_t binding_key(uint32_t modifiers, xkb_keysym_t sym) {
+    return (static_cast<uint64_t>(modifiers & BINDING_MODIFIERS) << 32) | xkb_keysym_to_lower(sym);
+}
+
+// While a modifier key itself goes down or up, the keyboard state still
+// reflects the other edge, so a key never counts as its own modifier.
+uint32_t modifier_of(xkb_keysym_t sym) {
+    switch (sym) {
+        case XKB_KEY_Shift_L:
+        case XKB_KEY_Shift_R:
+            return WLR_MODIFIER_SHIFT;
+        case XKB_KEY_Control_L:
+        case XKB_KEY_Control_R:
+            return WLR_MODIFIER_CTRL;
+        case XKB_KEY_Alt_L:
+        case XKB_KEY_Alt_R:
+        case XKB_KEY_Meta_L:
+        case XKB_KEY_Meta_R:
+            return WLR_MODIFIER_ALT;
+        case XKB_KEY_Super_L:
+        case XKB_KEY_Super_R:
+            return WLR_MODIFIER_LOGO;
+        default:
+            return 0;
+    }
+}
+
+bool parse_modifier(const std::string &name, uint32_t &modifier) {
+    const char *text = name.c_str();
+    if (!strcasecmp(text, "super") || !strcasecmp(text, "logo") || !strcasecmp(text, "mod4")) {
+        modifier = WLR_MODIFIER_LOGO;
+    } else if (!strcasecmp(text, "alt") || !strcasecmp(text, "mod1")) {
+        modifier = WLR_MODIFIER_ALT;
+    } else if (!strcasecmp(text, "ctrl") || !strcasecmp(text, "control")) {
+        modifier = WLR_MODIFIER_CTRL;
+    } else if (!strcasecmp(text, "shift")) {
+        modifier = WLR_MODIFIER_SHIFT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// "Super+Shift+Return" -> binding key. Returns false on unknown names.
+bool parse_combo(const std::string &combo, uint64_t &key) {
+    uint32_t modifiers = 0;
+    std::size_t start = 0;
+    while (true) {
+        const std::size_t plus = combo.find('+', start);
+        const std::string token = combo.substr(start, plus == std::string::npos ? std::string::npos : plus - start);
+        if (plus == std::string::npos) {
+            const xkb_keysym_t sym = xkb_keysym_from_name(token.c_str(), XKB_KEYSYM_CASE_INSENSITIVE);
+            if (sym == XKB_KEY_NoSymbol) {
+                return false;
+            }
+            key = binding_key(modifiers & ~modifier_of(sym), sym);
+            return true;
+        }
+
+        uint32_t modifier = 0;
+        if (!parse_modifier(token, modifier)) {
+            return false;
+        }
+        modifiers |= modifier;
+        start = plus + 1;
+    }
+}
+
+// "[--release] action [argument...]"
+bool parse_binding(const std::string &value, KeyBinding &binding, bool &on_release) {
+    std::istringstream stream(value);
+    std::string word;
+    stream >> word;
+    on_release = word == "--release";
+    if (on_release) {
+        stream >> word;
+    }
+
+    const auto *entry = std::find_if(std::begin(ACTIONS), std::end(ACTIONS), [&word](const ActionName &action) {
+        return word == action.name;
+    });
+    if (entry == std::end(ACTIONS)) {
+        return false;
+    }
+
+    binding.action = entry->action;
+    binding.repeats = entry->repeats && !on_release;
+    std::getline(stream >> std::ws, binding.argument);
+    return true;
+}
+
+void add_binding(KeybindingEngine &engine, const std::string &name, const std::string &value) {
+    BindingMode mode = BindingMode::DEFAULT;
+    std::string combo = name;
+    const std::size_t dot = name.find('.');
+    if (dot != std::string::npos) {
+        const std::string prefix = name.substr(0, dot);
+        if (prefix == "launcher") {
+            mode = BindingMode::LAUNCHER;
+        } else if (prefix == "switcher") {
+            mode = BindingMode::SWITCHER;
+        } else {
+            wlr_log(WLR_ERROR, "Unknown binding mode in 'bind.%s'", name.c_str());
+            return;
+        }
+        combo = name.substr(dot + 1);
+    }
+
+    uint64_t key = 0;
+    KeyBinding binding;
+    bool on_release = false;
+    if (!parse_combo(combo, key)) {
+        wlr_log(WLR_ERROR, "Cannot parse key combination in 'bind.%s'", name.c_str());
+        return;
+    }
+    if (!parse_binding(value, binding, on_release)) {
+        wlr_log(WLR_ERROR, "Unknown action '%s' for 'bind.%s'", value.c_str(), name.c_str());
+        return;
+    }
+
+    auto &table = engine.modes[static_cast<std::size_t>(mode)];
+    table.press.erase(key);
+    table.release.erase(key);
+    if (binding.action != BindingAction::NONE) {
+        (on_release ? table.release : table.press)[key] = std::move(binding);
+    }
+}
+
+// Modes fall back to DEFAULT, never to each other.
+const KeyBinding *lookup(const KeybindingEngine &engine, BindingMode mode, bool release, uint64_t key) {
+    for (const BindingMode candidate : {mode, BindingMode::DEFAULT}) {
+        const auto &table = engine.modes[static_cast<std::size_t>(candidate)];
+        const auto &bindings = release ? table.release : table.press;
+        auto it = bindings.find(key);
+        if (it != bindings.end()) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+BindingMode active_mode(const ArolloaServer *server) {
+    if (server->switcher.active) {
+        return BindingMode::SWITCHER;
+    }
+    return server->ui_state.launcher_visible ? BindingMode::LAUNCHER : BindingMode::DEFAULT;
+}
+
+const char *layout_name(WindowLayout layout) {
+    switch (layout) {
+        case WindowLayout::GRID:
+            return "grid";
+        case WindowLayout::ASYMMETRICAL:
+            return "asymmetrical";
+        case WindowLayout::FLOATING:
+            return "floating";
+    }
+    return "grid";
+}
+
+void set_layout(ArolloaServer *server, WindowLayout layout) {
+    tiling_set_mode(server, layout);
+    show_system_notification(server, "Layout", layout_name(layout));
+}
+
+void move_focused_view(ArolloaServer *server, const std::string &argument) {
+    ArolloaView *view = server->focused_view;
+    int dx = 0;
+    int dy = 0;
+    std::istringstream(argument) >> dx >> dy;
+    if (!view || !view->mapped || (dx == 0 && dy == 0)) {
+        return;
+    }
+
+    tiling_float_view(view);
+    view->x += dx;
+    view->y += dy;
+    view_index_update(server, view);
+    render_list_update(view);
+    cursor_rebase(server);
+    mark_ui_dirty(server);
+    mark_content_dirty(server);
+}
+
+// Bindings count workspaces from 1; anything unparsable is out of range.
+uint32_t workspace_number(const std::string &argument) {
+    uint32_t number = 0;
+    std::istringstream(argument) >> number;
+    return number - 1;
+}
+
+void focus_next_view(ArolloaServer *server) {
+    // The bottom-most mapped view comes to the top, so repeating the action
+    // cycles through every window.
+    ArolloaView *view = nullptr;
+    wl_list_for_each(view, &server->views, link) {
+        if (view->mapped && !view->hidden && view != server->focused_view) {
+            focus_view(server, view);
+            return;
+        }
+    }
+}
+
+void run_binding(ArolloaServer *server, const KeyBinding &binding) {
+    switch (binding.action) {
+        case BindingAction::NONE:
+            break;
+        case BindingAction::SPAWN:
+            launch_application(server, binding.argument, binding.argument);
+            break;
+        case BindingAction::EXIT:
+            wl_display_terminate(server->wl_display);
+            break;
+        case BindingAction::TOGGLE_LAUNCHER:
+            toggle_launcher(server);
+            break;
+        case BindingAction::LAUNCHER_CLOSE:
+            server->ui_state.launcher_visible = false;
+            cursor_rebase(server);
+            mark_ui_dirty(server);
+            break;
+        case BindingAction::LAUNCHER_NEXT:
+            focus_launcher_offset(server, 1);
+            break;
+        case BindingAction::LAUNCHER_PREV:
+            focus_launcher_offset(server, -1);
+            break;
+        case BindingAction::LAUNCHER_ACTIVATE:
+            activate_launcher_selection(server);
+            break;
+        case BindingAction::LAUNCHER_ERASE:
+            launcher_search_erase(server);
+            break;
+        case BindingAction::FOCUS_NEXT:
+            focus_next_view(server);
+            break;
+        case BindingAction::MOVE:
+            move_focused_view(server, binding.argument);
+            break;
+        case BindingAction::LAYOUT:
+            if (binding.argument == "asymmetrical") {
+                set_layout(server, WindowLayout::ASYMMETRICAL);
+            } else if (binding.argument == "floating") {
+                set_layout(server, WindowLayout::FLOATING);
+            } else {
+                set_layout(server, WindowLayout::GRID);
+            }
+            break;
+        case BindingAction::CYCLE_LAYOUT:
+            set_layout(server, static_cast<WindowLayout>((static_cast<int>(server->layout_mode) + 1) % 3));
+            break;
+        case BindingAction::TOGGLE_LOW_POWER:
+            toggle_low_power_mode(server);
+            break;
+        case BindingAction::WORKSPACE:
+            workspace_switch(server, output_at_cursor(server), workspace_number(binding.argument));
+            break;
+        case BindingAction::MOVE_TO_WORKSPACE:
+            workspace_move_view(server, server->focused_view, workspace_number(binding.argument));
+            break;
+        case BindingAction::TOGGLE_OVERVIEW:
+            overview_toggle(server);
+            break;
+        case BindingAction::SWITCHER_NEXT:
+            switcher_step(server, 1);
+            break;
+        case BindingAction::SWITCHER_PREV:
+            switcher_step(server, -1);
+            break;
+        case BindingAction::SWITCHER_CANCEL:
+            switcher_cancel(server);
+            break;
+    }
+}
+
+void stop_repeat(KeybindingEngine &engine) {
+    engine.repeat_keycode = 0;
+    if (engine.repeat_timer) {
+        wl_event_source_timer_update(engine.repeat_timer, 0);
+    }
+}
+
+int handle_repeat(void *data) {
+    auto *server = static_cast<ArolloaServer *>(data);
+    auto &engine = server->bindings;
+    if (engine.repeat_keycode == 0 || engine.repeat_rate <= 0) {
+        return 0;
+    }
+
+    wl_event_source_timer_update(engine.repeat_timer, std::max(1, 1000 / engine.repeat_rate));
+    run_binding(server, engine.repeat_binding);
+    return 0;
+}
+
+// wlroots leaves key repeat to clients, so bindings that make sense to hold
+// down repeat here using the keyboard's advertised rate and delay.
+void start_repeat(KeybindingEngine &engine, const KeyBinding &binding, const struct wlr_keyboard *keyboard,
+                  uint32_t keycode) {
+    if (!binding.repeats || !engine.repeat_timer || keyboard->repeat_info.rate <= 0) {
+        return;
+    }
+
+    engine.repeat_binding = binding;
+    engine.repeat_keycode = keycode;
+    engine.repeat_rate = keyboard->repeat_info.rate;
+    wl_event_source_timer_update(engine.repeat_timer, std::max(1, static_cast<int>(keyboard->repeat_info.delay)));
+}
+
+// Keysyms a key can match, in order: what the current state produces, then
+// the key's level-one keysym in the active layout and in the first layout.
+// "Super+Shift+1" thus matches although Shift turns the key into "exclam",
+// and Latin bindings keep working while a Cyrillic layout is active.
+void collect_syms(KeybindingEngine &engine, struct wlr_keyboard *keyboard, uint32_t keycode) {
+    auto &syms = engine.scratch_syms;
+    syms.clear();
+    const auto append = [&syms](const xkb_keysym_t *list, int count) {
+        for (int i = 0; i < count; ++i) {
+            if (std::find(syms.begin(), syms.end(), list[i]) == syms.end()) {
+                syms.push_back(list[i]);
+            }
+        }
+    };
+
+    const xkb_keycode_t code = keycode + 8;
+    const xkb_keysym_t *list = nullptr;
+    int count = xkb_state_key_get_syms(keyboard->xkb_state, code, &list);
+    append(list, count);
+
+    const xkb_layout_index_t layout = xkb_state_key_get_layout(keyboard->xkb_state, code);
+    count = xkb_keymap_key_get_syms_by_level(keyboard->keymap, code, layout, 0, &list);
+    append(list, count);
+    if (layout != 0) {
+        count = xkb_keymap_key_get_syms_by_level(keyboard->keymap, code, 0, 0, &list);
+        append(list, count);
+    }
+}
+
+bool take_swallowed(KeybindingEngine &engine, uint32_t keycode) {
+    auto it = std::find(engine.swallowed_keycodes.begin(), engine.swallowed_keycodes.end(), keycode);
+    if (it == engine.swallowed_keycodes.end()) {
+        return false;
+    }
+    engine.swallowed_keycodes.erase(it);
+    return true;
+}
+} // namespace
+
+void keybindings_init(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &engine = server->bindings;
+    for (auto &table : engine.modes) {
+        table.press.clear();
+        table.release.clear();
+    }
+
+    for (const auto &binding : DEFAULT_BINDINGS) {
+        add_binding(engine, binding.key, binding.value);
+    }
+    for (const auto &entry : get_config_entries("bind.")) {
+        add_binding(engine, entry.first, entry.second);
+    }
+
+    if (server->wl_display && !engine.repeat_timer) {
+        engine.repeat_timer = wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display), handle_repeat, server);
+    }
+
+    std::size_t count = 0;
+    for (const auto &table : engine.modes) {
+        count += table.press.size() + table.release.size();
+    }
+    wlr_log(WLR_INFO, "Loaded %zu keybindings", count);
+}
+
+void keybindings_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    if (server->bindings.repeat_timer) {
+        wl_event_source_remove(server->bindings.repeat_timer);
+        server->bindings.repeat_timer = nullptr;
+    }
+}
+
+// Returns true when the event was consumed by the compositor and must not
+// reach the focused client.
+bool keybindings_handle_key(ArolloaServer *server, struct wlr_keyboard *keyboard,
+                            const struct wlr_keyboard_key_event *event) {
+    if (!server || !keyboard || !event) {
+        return false;
+    }
+
+    auto &engine = server->bindings;
+    collect_syms(engine, keyboard, event->keycode);
+    const auto &syms = engine.scratch_syms;
+    const uint32_t modifiers = wlr_keyboard_get_modifiers(keyboard);
+    const BindingMode mode = active_mode(server);
+
+    if (event->state == WL_KEYBOARD_KEY_STATE_RELEASED) {
+        if (engine.repeat_keycode == event->keycode) {
+            stop_repeat(engine);
+        }
+
+        // A client that never saw the press must not see the release either.
+        const bool swallowed = take_swallowed(engine, event->keycode);
+        if (engine.last_pressed_keycode != event->keycode) {
+            return swallowed;
+        }
+        for (const xkb_keysym_t sym : syms) {
+            const KeyBinding *binding = lookup(engine, mode, true, binding_key(modifiers & ~modifier_of(sym), sym));
+            if (binding) {
+                engine.last_pressed_keycode = 0;
+                const KeyBinding action = *binding;
+                run_binding(server, action);
+                break;
+            }
+        }
+        return swallowed;
+    }
+
+    stop_repeat(engine);
+    engine.last_pressed_keycode = event->keycode;
+    for (const xkb_keysym_t sym : syms) {
+        const KeyBinding *binding = lookup(engine, mode, false, binding_key(modifiers & ~modifier_of(sym), sym));
+        if (!binding) {
+            continue;
+        }
+
+        // Copy first: the action may reload or reshape the binding tables.
+        const KeyBinding action = *binding;
+        engine.swallowed_keycodes.push_back(event->keycode);
+        start_repeat(engine, action, keyboard, event->keycode);
+        run_binding(server, action);
+        return true;
+    }
+
+    // The switcher is modal: other keys are swallowed until Alt goes up.
+    if (mode == BindingMode::SWITCHER) {
+        engine.swallowed_keycodes.push_back(event->keycode);
+        return true;
+    }
+
+    // The launcher is modal: unbound keys type into its search field and
+    // never reach the focused client.
+    if (mode == BindingMode::LAUNCHER) {
+        char text[16] = {};
+        const bool shortcut = modifiers & (WLR_MODIFIER_CTRL | WLR_MODIFIER_ALT | WLR_MODIFIER_LOGO);
+        if (!shortcut && xkb_state_key_get_utf8(keyboard->xkb_state, event->keycode + 8, text, sizeof(text)) > 0 &&
+            static_cast<unsigned char>(text[0]) >= 0x20 && text[0] != 0x7f) {
+            launcher_search_append(server, text);
+        }
+        engine.swallowed_keycodes.push_back(event->keycode);
+        return true;
+    }
+    return false;
+}
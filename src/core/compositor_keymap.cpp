@@ -0,0 +1,209 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// Bump when the cache file layout changes.
+constexpr const char *CACHE_MAGIC = "// arolloa-keymap-cache v1 ";
+
+const char *or_empty(const char *value) {
+    return value ? value : "";
+}
+
+std::string rules_key(const struct xkb_rule_names &rules) {
+    std::string key;
+    key.append(or_empty(rules.rules)).push_back('|');
+    key.append(or_empty(rules.model)).push_back('|');
+    key.append(or_empty(rules.layout)).push_back('|');
+    key.append(or_empty(rules.variant)).push_back('|');
+    key.append(or_empty(rules.options));
+    return key;
+}
+
+// Newest modification time and number of entries below an XKB component
+// directory. Files edited in place leave the directory mtime alone, so each
+// one is looked at; the count catches removals.
+void stamp_component(std::string &stamp, const std::filesystem::path &directory) {
+    int64_t newest = 0;
+    std::size_t count = 0;
+    auto fold = [&newest, &count](const std::filesystem::path &path) {
+        struct stat info = {};
+        if (stat(path.c_str(), &info) == 0) {
+            newest = std::max<int64_t>(newest, static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 +
+                                                   info.st_mtim.tv_nsec);
+            ++count;
+        }
+    };
+
+    fold(directory);
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator it(directory, error);
+    for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        fold(it->path());
+    }
+    stamp += std::to_string(newest) + "/" + std::to_string(count) + ":";
+}
+
+// Keymaps compile from every include path of the context: the user's
+// $XDG_CONFIG_HOME/xkb and ~/.xkb, /etc/xkb and the system data. Folding
+// their contents into the key retires cache entries once any of them
+// changes, whether by a package upgrade or a local edit.
+std::string xkb_data_stamp(struct xkb_context *context) {
+    std::string stamp;
+    for (unsigned int i = 0; i < xkb_context_num_include_paths(context); ++i) {
+        const std::filesystem::path root = xkb_context_include_path_get(context, i);
+        stamp += root.string() + "=";
+        for (const char *component : {"rules", "keycodes", "types", "compat", "symbols"}) {
+            stamp_component(stamp, root / component);
+        }
+        stamp.push_back(';');
+    }
+    return stamp;
+}
+
+std::filesystem::path cache_directory() {
+    const char *cache_home = getenv("XDG_CACHE_HOME");
+    if (cache_home && *cache_home) {
+        return std::filesystem::path(cache_home) / "arolloa" / "keymaps";
+    }
+    const char *home = getenv("HOME");
+    if (home && *home) {
+        return std::filesystem::path(home) / ".cache" / "arolloa" / "keymaps";
+    }
+    return {};
+}
+
+std::filesystem::path cache_file(const std::string &key) {
+    const std::filesystem::path directory = cache_directory();
+    if (directory.empty()) {
+        return {};
+    }
+
+    // FNV-1a; the full key is stored in the file and checked on load.
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.xkb", static_cast<unsigned long long>(hash));
+    return directory / name;
+}
+
+struct xkb_keymap *load_cached_keymap(struct xkb_context *context, const std::filesystem::path &path,
+                                      const std::string &key) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    std::string header;
+    std::getline(file, header);
+    if (header != CACHE_MAGIC + key) {
+        return nullptr;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+    return xkb_keymap_new_from_string(context, text.c_str(), XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
+}
+
+void store_cached_keymap(struct xkb_keymap *keymap, const std::filesystem::path &path, const std::string &key) {
+    char *text = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    if (!text) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+        free(text);
+        return;
+    }
+
+    // Write to a private temporary and rename so that a concurrent instance
+    // never reads a truncated keymap.
+    std::filesystem::path temporary = path;
+    temporary += ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file << CACHE_MAGIC << key << '\n' << text;
+        if (!file) {
+            free(text);
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    free(text);
+
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
+} // namespace
+
+// Returns a keymap for the given RMLVO names, owned by the cache. Keyboards
+// sharing a layout share one compiled keymap; across restarts the serialised
+// keymap is loaded from disk instead of being recompiled from the XKB rules.
+struct xkb_keymap *keymap_cache_get(ArolloaServer *server, const struct xkb_rule_names &rules) {
+    if (!server) {
+        return nullptr;
+    }
+
+    auto &cache = server->keymaps;
+    if (!cache.context) {
+        cache.context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+        if (!cache.context) {
+            wlr_log(WLR_ERROR, "Failed to create XKB context");
+            return nullptr;
+        }
+    }
+
+    const std::string names = rules_key(rules);
+    auto it = cache.keymaps.find(names);
+    if (it != cache.keymaps.end()) {
+        return it->second;
+    }
+
+    const std::string key = names + "|" + xkb_data_stamp(cache.context);
+    const std::filesystem::path path = cache_file(key);
+
+    struct xkb_keymap *keymap = path.empty() ? nullptr : load_cached_keymap(cache.context, path, key);
+    if (keymap) {
+        wlr_log(WLR_DEBUG, "Loaded cached keymap %s", path.c_str());
+    } else {
+        keymap = xkb_keymap_new_from_names(cache.context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        if (!keymap) {
+            wlr_log(WLR_ERROR, "Failed to compile keymap for '%s'", names.c_str());
+            return nullptr;
+        }
+        if (!path.empty()) {
+            store_cached_keymap(keymap, path, key);
+        }
+    }
+
+    cache.keymaps.emplace(names, keymap);
+    return keymap;
+}
+
+void keymap_cache_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &cache = server->keymaps;
+    for (auto &entry : cache.keymaps) {
+        xkb_keymap_unref(entry.second);
+    }
+    cache.keymaps.clear();
+    if (cache.context) {
+        xkb_context_unref(cache.context);
+        cache.context = nullptr;
+    }
+}
@@ -0,0 +1,284 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+constexpr int REPORT_INTERVAL_MS = 10000;
+constexpr std::size_t MAX_PENDING = 32;
+constexpr uint64_t EXPIRE_NS = 1000000000ull; // Inputs that change nothing visible
+
+uint64_t timespec_ns(const struct timespec &ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t monotonic_ns() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return timespec_ns(ts);
+}
+
+const char *source_name(LatencySource source) {
+    switch (source) {
+        case LatencySource::KEY:
+            return "key";
+        case LatencySource::POINTER_MOTION:
+            return "motion";
+        case LatencySource::POINTER_BUTTON:
+            return "button";
+        case LatencySource::COUNT:
+            break;
+    }
+    return "unknown";
+}
+
+// Upper bound in ms of the bucket holding the given fraction of samples.
+int percentile_ms(const uint32_t (&histogram)[LATENCY_BUCKETS], double fraction) {
+    uint64_t total = 0;
+    for (uint32_t count : histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const auto wanted = static_cast<uint64_t>(fraction * static_cast<double>(total));
+    uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        seen += histogram[bucket];
+        if (seen > wanted) {
+            return static_cast<int>(bucket) + 1;
+        }
+    }
+    return static_cast<int>(LATENCY_BUCKETS);
+}
+
+// Device timestamps are truncated CLOCK_MONOTONIC milliseconds on DRM and
+// libinput; unsigned wrap-around keeps the difference valid.
+double input_to_present_ms(const LatencySample &sample) {
+    const auto presented_ms = static_cast<uint32_t>(sample.presented_ns / 1000000ull);
+    return static_cast<double>(static_cast<uint32_t>(presented_ms - sample.event_msec));
+}
+
+// Frames that were never shown stay in the trace, but would skew the
+// histograms with their commit time.
+void record_sample(LatencyTracer &tracer, const LatencySample &sample) {
+    if (sample.presented) {
+        const uint64_t compositor_ms = (sample.presented_ns - sample.received_ns) / 1000000ull;
+        const std::size_t bucket = std::min<uint64_t>(compositor_ms, LATENCY_BUCKETS - 1);
+        ++tracer.histograms[static_cast<std::size_t>(sample.source)][bucket];
+    } else {
+        ++tracer.unpresented;
+    }
+    ++tracer.completed;
+
+    if (tracer.trace.size() < LATENCY_TRACE_SIZE) {
+        tracer.trace.push_back(sample);
+    } else {
+        tracer.trace[tracer.trace_head] = sample;
+        tracer.trace_head = (tracer.trace_head + 1) % LATENCY_TRACE_SIZE;
+    }
+}
+
+void write_report(const LatencyTracer &tracer) {
+    FILE *file = std::fopen(tracer.report_path.c_str(), "w");
+    if (!file) {
+        return;
+    }
+
+    std::fprintf(file, "# arolloa input latency, receive to present (ms)\n");
+    std::fprintf(file, "# completed %llu expired %llu unpresented %llu\n",
+                 static_cast<unsigned long long>(tracer.completed), static_cast<unsigned long long>(tracer.expired),
+                 static_cast<unsigned long long>(tracer.unpresented));
+    for (std::size_t source = 0; source < static_cast<std::size_t>(LatencySource::COUNT); ++source) {
+        const auto &histogram = tracer.histograms[source];
+        std::fprintf(file, "%s p50 %d p99 %d |", source_name(static_cast<LatencySource>(source)),
+                     percentile_ms(histogram, 0.5), percentile_ms(histogram, 0.99));
+        for (std::size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+            std::fprintf(file, " %u", histogram[bucket]);
+        }
+        std::fprintf(file, "\n");
+    }
+
+    std::fprintf(file, "# source event_msec received_ns committed_ns presented_ns presented input_to_present_ms\n");
+    for (std::size_t i = 0; i < tracer.trace.size(); ++i) {
+        const auto &sample = tracer.trace[(tracer.trace_head + i) % tracer.trace.size()];
+        std::fprintf(file, "%s %u %llu %llu %llu %d %.0f\n", source_name(sample.source), sample.event_msec,
+                     static_cast<unsigned long long>(sample.received_ns),
+                     static_cast<unsigned long long>(sample.committed_ns),
+                     static_cast<unsigned long long>(sample.presented_ns), sample.presented ? 1 : 0,
+                     input_to_present_ms(sample));
+    }
+    std::fclose(file);
+}
+
+int handle_report(void *data) {
+    auto *server = static_cast<ArolloaServer *>(data);
+    auto &tracer = server->latency;
+    if (tracer.completed != tracer.reported) {
+        tracer.reported = tracer.completed;
+        write_report(tracer);
+        wlr_log(WLR_INFO, "Input latency: %s", latency_trace_summary(server).c_str());
+    }
+    wl_event_source_timer_update(tracer.report_timer, REPORT_INTERVAL_MS);
+    return 0;
+}
+} // namespace
+
+void latency_trace_init(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &tracer = server->latency;
+    tracer.enabled = get_config_bool("debug.latency_trace", false);
+    if (!tracer.enabled || !server->wl_display) {
+        return;
+    }
+
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    tracer.report_path = get_config_string("debug.latency_trace_file",
+        std::string(runtime_dir ? runtime_dir : "/tmp") + "/arolloa-latency.txt");
+    tracer.pending.reserve(MAX_PENDING);
+    tracer.trace.reserve(LATENCY_TRACE_SIZE);
+
+    tracer.report_timer = wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display), handle_report, server);
+    if (tracer.report_timer) {
+        wl_event_source_timer_update(tracer.report_timer, REPORT_INTERVAL_MS);
+    }
+    wlr_log(WLR_INFO, "Input latency tracing enabled, reporting to %s", tracer.report_path.c_str());
+}
+
+void latency_trace_finish(ArolloaServer *server) {
+    if (!server || !server->latency.enabled) {
+        return;
+    }
+
+    auto &tracer = server->latency;
+    if (tracer.report_timer) {
+        wl_event_source_remove(tracer.report_timer);
+        tracer.report_timer = nullptr;
+    }
+    if (tracer.completed > 0) {
+        write_report(tracer);
+    }
+}
+
+// Tags an input event. Only the oldest untracked event per source is kept
+// while earlier ones are in flight, which is the worst case for that frame.
+void latency_trace_input(ArolloaServer *server, LatencySource source, uint32_t event_msec,
+                         const struct wlr_surface *target) {
+    if (!server || !server->latency.enabled) {
+        return;
+    }
+
+    auto &tracer = server->latency;
+    const bool tracked = std::any_of(tracer.pending.begin(), tracer.pending.end(),
+        [source](const LatencyTracer::PendingEvent &event) {
+            return event.sample.source == source && !event.output;
+        });
+    if (tracked || tracer.pending.size() >= MAX_PENDING) {
+        return;
+    }
+
+    LatencyTracer::PendingEvent event;
+    event.sample.source = source;
+    event.sample.event_msec = event_msec;
+    event.sample.received_ns = monotonic_ns();
+    event.target = target;
+    event.ui_generation = server->ui_generation;
+    tracer.pending.push_back(event);
+}
+
+void latency_trace_surface_commit(ArolloaServer *server, const struct wlr_surface *surface) {
+    if (!server || !server->latency.enabled || !surface) {
+        return;
+    }
+
+    for (auto &event : server->latency.pending) {
+        if (event.target == surface) {
+            event.ready = true;
+        }
+    }
+}
+
+// An event is shown by the first commit after its client responded or the
+// compositor UI changed in reaction to it.
+void latency_trace_output_commit(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server || !server->latency.enabled) {
+        return;
+    }
+
+    auto &tracer = server->latency;
+    const uint64_t now = monotonic_ns();
+    for (auto &event : tracer.pending) {
+        if (event.output) {
+            continue;
+        }
+        if (event.ready || event.ui_generation != server->ui_generation) {
+            event.output = output;
+            event.sample.committed_ns = now;
+        }
+    }
+
+    const auto stale = std::remove_if(tracer.pending.begin(), tracer.pending.end(),
+        [now](const LatencyTracer::PendingEvent &event) {
+            return !event.output && now - event.sample.received_ns > EXPIRE_NS;
+        });
+    tracer.expired += static_cast<uint64_t>(tracer.pending.end() - stale);
+    tracer.pending.erase(stale, tracer.pending.end());
+}
+
+// Only one commit per output is in flight, so the first present event after
+// a commit belongs to it. when is the backend's presentation timestamp on
+// CLOCK_MONOTONIC, or nullptr for a discarded frame, which falls back to the
+// commit time.
+void latency_trace_output_present(ArolloaServer *server, ArolloaOutput *output, const struct timespec *when) {
+    if (!server || !server->latency.enabled) {
+        return;
+    }
+
+    auto &tracer = server->latency;
+    auto it = tracer.pending.begin();
+    while (it != tracer.pending.end()) {
+        if (it->output != output) {
+            ++it;
+            continue;
+        }
+        it->sample.presented = when != nullptr;
+        it->sample.presented_ns = when ? timespec_ns(*when) : it->sample.committed_ns;
+        record_sample(tracer, it->sample);
+        it = tracer.pending.erase(it);
+    }
+}
+
+void latency_trace_forget_output(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server || !server->latency.enabled) {
+        return;
+    }
+
+    auto &pending = server->latency.pending;
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+        [output](const LatencyTracer::PendingEvent &event) {
+            return event.output == output;
+        }), pending.end());
+}
+
+std::string latency_trace_summary(const ArolloaServer *server) {
+    if (!server || !server->latency.enabled) {
+        return {};
+    }
+
+    std::string summary;
+    for (std::size_t source = 0; source < static_cast<std::size_t>(LatencySource::COUNT); ++source) {
+        const auto &histogram = server->latency.histograms[source];
+        if (!summary.empty()) {
+            summary += ", ";
+        }
+        summary += source_name(static_cast<LatencySource>(source));
+        summary += " p50 " + std::to_string(percentile_ms(histogram, 0.5));
+        summary += " p99 " + std::to_string(percentile_ms(histogram, 0.99)) + " ms";
+    }
+    return summary;
+}
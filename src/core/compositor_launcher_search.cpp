@@ -0,0 +1,257 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace {
+// Matches inside the name always outrank matches found only in the
+// description or category.
+constexpr int NAME_MATCH_BONUS = 1000;
+constexpr int BOUNDARY_BONUS = 8;
+constexpr int CONSECUTIVE_BONUS = 5;
+constexpr int MAX_GAP_PENALTY = 3;
+
+// One bit per ASCII letter and digit; other bytes share the upper bits.
+uint64_t char_bit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') {
+        return 1ull << (c - 'a');
+    }
+    if (c >= '0' && c <= '9') {
+        return 1ull << (26 + c - '0');
+    }
+    return 1ull << (36 + c % 28);
+}
+
+uint64_t char_mask(std::string_view text) {
+    uint64_t mask = 0;
+    for (unsigned char c : text) {
+        if (c != ' ') {
+            mask |= char_bit(c);
+        }
+    }
+    return mask;
+}
+
+std::string lowercase(const std::string &text) {
+    std::string result = text;
+    for (char &c : result) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return result;
+}
+
+bool is_boundary(std::string_view text, std::size_t position) {
+    if (position == 0) {
+        return true;
+    }
+    const char previous = text[position - 1];
+    return previous == ' ' || previous == '-' || previous == '_' || previous == '.' || previous == '/';
+}
+
+// Subsequence match. Each query character prefers the next word-boundary
+// occurrence when one exists before the text runs out, so "ff" ranks
+// "Firefox Foo" above "Fluffy". Returns -1 when the query is not a
+// subsequence of the text.
+int fuzzy_score(std::string_view text, std::string_view query) {
+    int score = 0;
+    std::size_t position = 0;
+    std::size_t previous = std::string_view::npos;
+    for (std::size_t i = 0; i < query.size(); ++i) {
+        const char wanted = query[i];
+        if (wanted == ' ') {
+            continue;
+        }
+        std::size_t found = text.find(wanted, position);
+        if (found == std::string_view::npos) {
+            return -1;
+        }
+
+        // Staying consecutive beats jumping to a boundary further on.
+        if (found != previous + 1) {
+            for (std::size_t candidate = found; candidate != std::string_view::npos;
+                 candidate = text.find(wanted, candidate + 1)) {
+                if (is_boundary(text, candidate)) {
+                    // Only take it if the rest of the query still fits.
+                    std::size_t rest = candidate + 1;
+                    bool fits = true;
+                    for (std::size_t j = i + 1; j < query.size() && fits; ++j) {
+                        if (query[j] == ' ') {
+                            continue;
+                        }
+                        rest = text.find(query[j], rest);
+                        fits = rest != std::string_view::npos;
+                        ++rest;
+                    }
+                    if (fits) {
+                        found = candidate;
+                    }
+                    break;
+                }
+            }
+        }
+
+        score += 1;
+        if (is_boundary(text, found)) {
+            score += BOUNDARY_BONUS;
+        }
+        if (previous != std::string_view::npos && found == previous + 1) {
+            score += CONSECUTIVE_BONUS;
+        } else {
+            score -= static_cast<int>(std::min<std::size_t>(found - position, MAX_GAP_PENALTY));
+        }
+        previous = found;
+        position = found + 1;
+    }
+    return score;
+}
+
+int entry_score(const LauncherSearchIndex &index, uint32_t entry, std::string_view query) {
+    const std::string_view text = index.haystacks[entry];
+    const std::string_view name = text.substr(0, index.name_lengths[entry]);
+    const int name_score = fuzzy_score(name, query);
+    if (name_score >= 0) {
+        // Shorter names are closer to what was typed.
+        return NAME_MATCH_BONUS + name_score * 4 - static_cast<int>(name.size() / 4);
+    }
+    return fuzzy_score(text, query);
+}
+
+// Narrows the matches of the previous step to the current query, ranks
+// them and publishes the result as launcher_matches.
+void run_query(ArolloaServer *server) {
+    auto &index = server->launcher_search;
+    auto &ui = server->ui_state;
+    const std::string_view query = ui.launcher_query;
+    const auto &previous = index.steps.back().matches;
+    const uint64_t mask = char_mask(query);
+
+    std::vector<std::pair<int, uint32_t>> ranked;
+    ranked.reserve(previous.size());
+    for (uint32_t entry : previous) {
+        if ((index.masks[entry] & mask) != mask) {
+            continue;
+        }
+        const int score = entry_score(index, entry, query);
+        if (score >= 0) {
+            ranked.emplace_back(score, entry);
+        }
+    }
+
+    // Equal scores fall back to catalog order, which is alphabetical.
+    std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    LauncherSearchIndex::Step step;
+    step.query_length = query.size();
+    step.matches.reserve(ranked.size());
+    for (const auto &item : ranked) {
+        step.matches.push_back(item.second);
+    }
+    ui.launcher_matches = step.matches;
+    index.steps.push_back(std::move(step));
+}
+
+void show_results(ArolloaServer *server) {
+    server->ui_state.highlighted_index = 0;
+    launcher_reveal_highlight(server);
+    mark_ui_dirty(server);
+}
+} // namespace
+
+// Reindexes launcher_entries after the catalog changed and reapplies the
+// current query from scratch.
+void launcher_search_rebuild(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &index = server->launcher_search;
+    auto &ui = server->ui_state;
+    const std::size_t count = ui.launcher_entries.size();
+    index.haystacks.resize(count);
+    index.name_lengths.resize(count);
+    index.masks.resize(count);
+    for (std::size_t entry = 0; entry < count; ++entry) {
+        const auto &launcher_entry = ui.launcher_entries[entry];
+        const std::string name = lowercase(launcher_entry.name);
+        index.haystacks[entry] = name + " " + lowercase(launcher_entry.description) + " " +
+                                 lowercase(launcher_entry.category);
+        index.name_lengths[entry] = static_cast<uint32_t>(name.size());
+        index.masks[entry] = char_mask(index.haystacks[entry]);
+    }
+
+    ++index.generation;
+    index.steps.clear();
+    LauncherSearchIndex::Step all;
+    all.matches.resize(count);
+    for (std::size_t entry = 0; entry < count; ++entry) {
+        all.matches[entry] = static_cast<uint32_t>(entry);
+    }
+    ui.launcher_matches = all.matches;
+    index.steps.push_back(std::move(all));
+
+    if (!ui.launcher_query.empty()) {
+        run_query(server);
+    }
+    if (ui.highlighted_index >= ui.launcher_matches.size()) {
+        ui.highlighted_index = 0;
+    }
+}
+
+// Each typed character only re-scores the entries that matched before it.
+void launcher_search_append(ArolloaServer *server, const std::string &text) {
+    if (!server || text.empty()) {
+        return;
+    }
+    if (server->launcher_search.steps.empty()) {
+        launcher_search_rebuild(server);
+    }
+
+    server->ui_state.launcher_query += lowercase(text);
+    run_query(server);
+    show_results(server);
+}
+
+// Removes the last character, returning to the result set it narrowed.
+void launcher_search_erase(ArolloaServer *server) {
+    if (!server || server->ui_state.launcher_query.empty()) {
+        return;
+    }
+
+    auto &ui = server->ui_state;
+    auto &steps = server->launcher_search.steps;
+    std::size_t length = ui.launcher_query.size() - 1;
+    // Step back over UTF-8 continuation bytes.
+    while (length > 0 && (static_cast<unsigned char>(ui.launcher_query[length]) & 0xc0) == 0x80) {
+        --length;
+    }
+    ui.launcher_query.resize(length);
+
+    while (steps.size() > 1 && steps.back().query_length > length) {
+        steps.pop_back();
+    }
+    if (steps.back().query_length == length) {
+        ui.launcher_matches = steps.back().matches;
+    } else {
+        // Text arrived in a multi-character chunk; recompute from the full set.
+        steps.resize(1);
+        run_query(server);
+    }
+    show_results(server);
+}
+
+void launcher_search_clear(ArolloaServer *server) {
+    if (!server || server->ui_state.launcher_query.empty()) {
+        return;
+    }
+
+    auto &steps = server->launcher_search.steps;
+    server->ui_state.launcher_query.clear();
+    if (!steps.empty()) {
+        steps.resize(1);
+        server->ui_state.launcher_matches = steps.front().matches;
+    }
+    show_results(server);
+}
@@ -6,10 +6,25 @@
 #include <ctime>
 #include <sstream>
 
+#include <wlr/interfaces/wlr_buffer.h>
 #include <wlr/render/pass.h>
+#include <wlr/render/pixman.h>
+#include <wlr/util/region.h>
+#include <wlr/version.h>
 #include <drm_fourcc.h>
 
 namespace {
+// Window decoration extents around the client surface, see render_swiss_window.
+constexpr double WINDOW_HEADER_HEIGHT = 34.0;
+constexpr double WINDOW_FRAME_MARGIN = 8.0;
+constexpr double WINDOW_FRAME_TOP_GAP = 10.0;
+constexpr double WINDOW_CONTROL_HIT_RADIUS = 10.0; // Drawn controls have a 6 px radius
+
+// Fullscreen views lose their frame until they leave fullscreen.
+bool draws_chrome(const ArolloaView *view) {
+    return view->server_decorated && !view->fullscreen;
+}
+
 float linear_interpolate(float from, float to, float t) {
     return from + (to - from) * t;
 }
@@ -69,23 +84,16 @@ void set_source_color(cairo_t *cairo, const SwissDesign::Color &color, float opa
     cairo_set_source_rgba(cairo, color.r, color.g, color.b, color.a * opacity);
 }
 
-int count_mapped_views(const ArolloaServer *server) {
-    int count = 0;
-    ArolloaView *view = nullptr;
-    wl_list_for_each(view, &server->views, link) {
-        if (view->mapped) {
-            ++count;
-        }
-    }
-    return count;
-}
-
 std::string format_debug_info(const ArolloaServer *server) {
     std::ostringstream ss;
     ss << (server->nested_backend_active ? "Nested" : "Direct");
-    ss << " | Views " << count_mapped_views(server);
+    ss << " | Views " << server->render_list.live;
     ss << " | Cursor " << static_cast<int>(server->cursor_x) << "," << static_cast<int>(server->cursor_y);
     ss << " | Animations " << (server->animations.empty() ? "idle" : std::to_string(server->animations.size()));
+    ss << " | Quality " << render_quality_name(server->quality.level);
+    if (server->latency.enabled) {
+        ss << " | Latency " << latency_trace_summary(server);
+    }
     return ss.str();
 }
 
@@ -128,23 +136,29 @@ void draw_text_center(cairo_t *cr, PangoLayout *layout, const std::string &text,
     cairo_restore(cr);
 }
 
-void draw_panel_apps(cairo_t *cr, const ArolloaServer *server, float opacity) {
-    const double icon_size = 28.0;
-    const double spacing = 18.0;
-    double x = FOREST_PANEL_MENU_WIDTH + spacing;
-    const double y = (SwissDesign::PANEL_HEIGHT - icon_size) / 2.0;
+void draw_rounded_rect(cairo_t *cr, double x, double y, double width, double height, double radius);
 
-    for (std::size_t index = 0; index < server->ui_state.panel_apps.size(); ++index) {
+void draw_panel_apps(cairo_t *cr, const ArolloaServer *server, const ChromeLayout &layout, float opacity) {
+    const bool halos = quality_draws_hover_halos(server);
+    const std::size_t count = std::min(server->ui_state.panel_apps.size(), layout.panel_apps.size());
+
+    for (std::size_t index = 0; index < count; ++index) {
         const auto &app = server->ui_state.panel_apps[index];
+        const auto &rect = layout.panel_apps[index];
+        const double x = rect.x;
+        const double y = rect.y;
+        const double icon_size = rect.width;
         const bool hovered = static_cast<int>(index) == server->ui_state.hovered_panel_index;
         const float progress = hovered ? server->ui_state.panel_hover_progress : 0.0f;
         const float halo_opacity = 0.12f + 0.35f * progress;
 
-        cairo_save(cr);
-        draw_rounded_rect(cr, x - 6.0, y - 3.0, icon_size + 12.0, icon_size + 6.0, 10.0);
-        set_source_color(cr, lighten(server->ui_state.panel_base, hovered ? 0.0f : 0.18f), opacity * halo_opacity);
-        cairo_fill(cr);
-        cairo_restore(cr);
+        if (halos) {
+            cairo_save(cr);
+            draw_rounded_rect(cr, x - 6.0, y - 3.0, icon_size + 12.0, icon_size + 6.0, 10.0);
+            set_source_color(cr, lighten(server->ui_state.panel_base, hovered ? 0.0f : 0.18f), opacity * halo_opacity);
+            cairo_fill(cr);
+            cairo_restore(cr);
+        }
 
         cairo_save(cr);
         draw_rounded_rect(cr, x, y, icon_size, icon_size, 8.0);
@@ -158,27 +172,30 @@ void draw_panel_apps(cairo_t *cr, const ArolloaServer *server, float opacity) {
             draw_text(cr, server->pango_layout, app.icon_label, x + 6.0, y + 6.0,
                       SwissDesign::WHITE, opacity);
         }
-
-        x += icon_size + spacing;
     }
 }
 
-void draw_tray_icons(cairo_t *cr, const ArolloaServer *server, int width, float opacity) {
-    double x = static_cast<double>(width) - 20.0;
-    const double icon_size = 24.0;
+void draw_tray_icons(cairo_t *cr, const ArolloaServer *server, const ChromeLayout &layout, float opacity) {
+    const bool halos = quality_draws_hover_halos(server);
+    const std::size_t count = std::min(server->ui_state.tray_icons.size(), layout.tray_icons.size());
 
-    for (int index = static_cast<int>(server->ui_state.tray_icons.size()) - 1; index >= 0; --index) {
-        const auto &indicator = server->ui_state.tray_icons[static_cast<std::size_t>(index)];
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        const auto &indicator = server->ui_state.tray_icons[slot];
+        const auto &rect = layout.tray_icons[slot];
+        const int index = static_cast<int>(slot);
         const bool hovered = index == server->ui_state.hovered_tray_index;
         const float progress = hovered ? server->ui_state.tray_hover_progress : 0.0f;
-
-        x -= icon_size;
-        cairo_save(cr);
-        draw_rounded_rect(cr, x - 6.0, SwissDesign::PANEL_HEIGHT / 2.0 - icon_size / 2.0 - 4.0,
-                          icon_size + 12.0, icon_size + 8.0, 9.0);
-        set_source_color(cr, lighten(server->ui_state.panel_base, hovered ? 0.05f : 0.15f), opacity * (0.2f + 0.4f * progress));
-        cairo_fill(cr);
-        cairo_restore(cr);
+        const double x = rect.x;
+        const double icon_size = rect.width;
+
+        if (halos) {
+            cairo_save(cr);
+            draw_rounded_rect(cr, x - 6.0, SwissDesign::PANEL_HEIGHT / 2.0 - icon_size / 2.0 - 4.0,
+                              icon_size + 12.0, icon_size + 8.0, 9.0);
+            set_source_color(cr, lighten(server->ui_state.panel_base, hovered ? 0.05f : 0.15f), opacity * (0.2f + 0.4f * progress));
+            cairo_fill(cr);
+            cairo_restore(cr);
+        }
 
         cairo_save(cr);
         cairo_arc(cr, x + icon_size / 2.0, SwissDesign::PANEL_HEIGHT / 2.0, icon_size / 2.4, 0, 2 * kPi);
@@ -192,8 +209,6 @@ void draw_tray_icons(cairo_t *cr, const ArolloaServer *server, int width, float
                       SwissDesign::PANEL_HEIGHT / 2.0 - 7.0, server->ui_state.panel_text,
                       opacity, PANGO_ALIGN_LEFT);
         }
-
-        x -= 20.0;
     }
 }
 
@@ -229,69 +244,183 @@ void draw_rounded_rect(cairo_t *cr, double x, double y, double width, double hei
     cairo_close_path(cr);
 }
 
-void render_launcher_overlay(cairo_t *cr, ArolloaServer *server, int width, int height, float opacity) {
+// Bounded so a long scroll through the catalog cannot pile up surfaces.
+constexpr std::size_t LAUNCHER_ROW_CACHE_SIZE = 48;
+
+// Row text is laid out relative to the card's top-left corner.
+void rasterise_launcher_row(cairo_surface_t *surface, const ArolloaServer *server, const LauncherGeometry &geometry,
+                            const LauncherEntry &entry, bool highlighted) {
+    cairo_t *cr = cairo_create(surface);
+    PangoLayout *layout = pango_cairo_create_layout(cr);
+    const SwissDesign::Color &text = server->ui_state.panel_text;
+    const double text_x = 24.0;
+    const double category_x = geometry.panel.width - 92.0 - (geometry.entry_x - geometry.panel.x);
+
+    apply_font(layout, SwissDesign::PRIMARY_FONT, 15);
+    draw_text(cr, layout, entry.name, text_x, 14.0, highlighted ? SwissDesign::WHITE : text, 1.0f);
+
+    apply_font(layout, SwissDesign::SECONDARY_FONT, 10);
+    draw_text(cr, layout, entry.description, text_x, 36.0, lighten(text, highlighted ? 0.6f : 0.35f), 0.9f);
+
+    apply_font(layout, SwissDesign::MONO_FONT, 9);
+    draw_text(cr, layout, entry.category, category_x, 16.0, lighten(text, 0.5f), 1.0f, PANGO_ALIGN_RIGHT);
+
+    g_object_unref(layout);
+    cairo_destroy(cr);
+}
+
+cairo_surface_t *cached_launcher_row(ArolloaServer *server, const LauncherGeometry &geometry, uint32_t entry,
+                                     bool highlighted) {
+    auto &cache = server->launcher_rows;
+    const int width = static_cast<int>(std::ceil(geometry.entry_width));
+    const int height = static_cast<int>(std::ceil(geometry.entry_height));
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    if (cache.width != width || cache.height != height || cache.generation != server->launcher_search.generation) {
+        launcher_row_cache_clear(server);
+        cache.width = width;
+        cache.height = height;
+        cache.generation = server->launcher_search.generation;
+    }
+
+    ++cache.use_counter;
+    for (auto &row : cache.rows) {
+        if (row.entry == entry && row.highlighted == highlighted) {
+            row.last_used = cache.use_counter;
+            return row.surface;
+        }
+    }
+
+    if (cache.rows.size() >= LAUNCHER_ROW_CACHE_SIZE) {
+        auto oldest = std::min_element(cache.rows.begin(), cache.rows.end(), [](const auto &a, const auto &b) {
+            return a.last_used < b.last_used;
+        });
+        cairo_surface_destroy(oldest->surface);
+        cache.rows.erase(oldest);
+    }
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+    rasterise_launcher_row(surface, server, geometry, server->ui_state.launcher_entries[entry], highlighted);
+
+    LauncherRowCache::Row row;
+    row.entry = entry;
+    row.highlighted = highlighted;
+    row.surface = surface;
+    row.last_used = cache.use_counter;
+    cache.rows.push_back(row);
+    return surface;
+}
+
+void render_launcher_overlay(cairo_t *cr, ArolloaServer *server, const ChromeLayout &layout, float opacity) {
     if (!server->ui_state.launcher_visible || !server->pango_layout) {
         return;
     }
 
+    // Under load the launcher drops the backdrop dim and rounded cards in
+    // favour of plain rectangles, which rasterise much faster.
+    const bool flat = quality_uses_flat_surfaces(server);
+
     cairo_save(cr);
-    set_source_color(cr, SwissDesign::BLACK, 0.35f * opacity);
-    cairo_rectangle(cr, 0, 0, width, height);
-    cairo_fill(cr);
+    if (!flat) {
+        set_source_color(cr, SwissDesign::BLACK, 0.35f * opacity);
+        cairo_rectangle(cr, 0, 0, layout.layout_box.width, layout.layout_box.height);
+        cairo_fill(cr);
+    }
 
-    const double panel_width = std::min<double>(FOREST_LAUNCHER_WIDTH, width - 120.0);
-    const double panel_height = std::min<double>(height * 0.62,
-        std::max<double>(SwissDesign::PANEL_HEIGHT * 5.0,
-            server->ui_state.launcher_entries.size() * FOREST_LAUNCHER_ENTRY_HEIGHT + 160.0));
-    const double start_x = (width - panel_width) / 2.0;
-    const double start_y = (height - panel_height) / 2.0;
+    const auto &geometry = layout.launcher;
+    const double panel_width = geometry.panel.width;
+    const double panel_height = geometry.panel.height;
+    const double start_x = geometry.panel.x;
+    const double start_y = geometry.panel.y;
 
-    draw_rounded_rect(cr, start_x, start_y, panel_width, panel_height, 22.0);
+    if (flat) {
+        cairo_rectangle(cr, start_x, start_y, panel_width, panel_height);
+    } else {
+        draw_rounded_rect(cr, start_x, start_y, panel_width, panel_height, 22.0);
+    }
     set_source_color(cr, lighten(server->ui_state.panel_base, 0.04f), 0.98f * opacity);
     cairo_fill(cr);
 
-    cairo_save(cr);
-    draw_rounded_rect(cr, start_x, start_y, panel_width, 64.0, 22.0);
-    set_source_color(cr, server->ui_state.accent_color, 0.12f * opacity);
-    cairo_fill(cr);
-    cairo_restore(cr);
+    if (!flat) {
+        cairo_save(cr);
+        draw_rounded_rect(cr, start_x, start_y, panel_width, 64.0, 22.0);
+        set_source_color(cr, server->ui_state.accent_color, 0.12f * opacity);
+        cairo_fill(cr);
+        cairo_restore(cr);
+    }
 
     apply_font(server->pango_layout, SwissDesign::PRIMARY_FONT, 18);
     draw_text(cr, server->pango_layout, "Swiss Application Grid", start_x + 36.0, start_y + 24.0,
               server->ui_state.panel_text, opacity);
 
     apply_font(server->pango_layout, SwissDesign::SECONDARY_FONT, 11);
-    draw_text(cr, server->pango_layout, "Curated workspaces, tools, and services",
-              start_x + 36.0, start_y + 48.0, lighten(server->ui_state.panel_text, 0.35f), opacity * 0.9f);
+    const std::string &query = server->ui_state.launcher_query;
+    if (query.empty()) {
+        draw_text(cr, server->pango_layout, "Type to search applications",
+                  start_x + 36.0, start_y + 48.0, lighten(server->ui_state.panel_text, 0.35f), opacity * 0.9f);
+    } else {
+        const std::size_t count = server->ui_state.launcher_matches.size();
+        const std::string summary = query + "  (" + std::to_string(count) + (count == 1 ? " match)" : " matches)");
+        draw_text(cr, server->pango_layout, summary, start_x + 36.0, start_y + 48.0, server->ui_state.panel_text,
+                  opacity);
+    }
 
-    double entry_y = start_y + 96.0;
-    std::size_t index = 0;
-    for (const auto &entry : server->ui_state.launcher_entries) {
-        const bool highlighted = index == server->ui_state.highlighted_index;
-        cairo_save(cr);
-        draw_rounded_rect(cr, start_x + 32.0, entry_y, panel_width - 64.0, FOREST_LAUNCHER_ENTRY_HEIGHT - 10.0, 14.0);
-        if (highlighted) {
-            set_source_color(cr, server->ui_state.accent_color, 0.55f * opacity);
+    // Only rows intersecting the viewport are drawn; their text comes from
+    // the row cache, so scrolling costs a few blits per frame whatever the
+    // catalog size.
+    const auto &ui = server->ui_state;
+    const std::size_t count = ui.launcher_matches.size();
+    const double scroll = ui.launcher_scroll;
+    const LauncherRowRange rows = launcher_visible_rows(geometry, count, scroll);
+
+    cairo_save(cr);
+    cairo_rectangle(cr, start_x, geometry.entry_y, panel_width, geometry.rows_height);
+    cairo_clip(cr);
+    for (std::size_t row = rows.first; row < rows.last; ++row) {
+        const double entry_y = launcher_row_y(geometry, count, scroll, row);
+        const bool highlighted = row == ui.highlighted_index;
+        if (flat) {
+            if (highlighted) {
+                cairo_save(cr);
+                cairo_rectangle(cr, geometry.entry_x, entry_y, geometry.entry_width, geometry.entry_height);
+                set_source_color(cr, ui.accent_color, 0.55f * opacity);
+                cairo_fill(cr);
+                cairo_restore(cr);
+            }
         } else {
-            set_source_color(cr, lighten(server->ui_state.panel_base, 0.1f), 0.5f * opacity);
+            cairo_save(cr);
+            draw_rounded_rect(cr, geometry.entry_x, entry_y, geometry.entry_width, geometry.entry_height, 14.0);
+            if (highlighted) {
+                set_source_color(cr, ui.accent_color, 0.55f * opacity);
+            } else {
+                set_source_color(cr, lighten(ui.panel_base, 0.1f), 0.5f * opacity);
+            }
+            cairo_fill(cr);
+            cairo_restore(cr);
         }
-        cairo_fill(cr);
-        cairo_restore(cr);
-
-        apply_font(server->pango_layout, SwissDesign::PRIMARY_FONT, 15);
-        draw_text(cr, server->pango_layout, entry.name, start_x + 56.0, entry_y + 14.0,
-                  highlighted ? SwissDesign::WHITE : server->ui_state.panel_text, opacity);
 
-        apply_font(server->pango_layout, SwissDesign::SECONDARY_FONT, 10);
-        draw_text(cr, server->pango_layout, entry.description, start_x + 56.0, entry_y + 36.0,
-                  lighten(server->ui_state.panel_text, highlighted ? 0.6f : 0.35f), opacity * 0.9f);
-
-        apply_font(server->pango_layout, SwissDesign::MONO_FONT, 9);
-        draw_text(cr, server->pango_layout, entry.category, start_x + panel_width - 92.0,
-                  entry_y + 16.0, lighten(server->ui_state.panel_text, 0.5f), opacity, PANGO_ALIGN_RIGHT);
+        if (cairo_surface_t *text = cached_launcher_row(server, geometry, ui.launcher_matches[row], highlighted)) {
+            cairo_set_source_surface(cr, text, geometry.entry_x, entry_y);
+            cairo_paint_with_alpha(cr, opacity);
+        }
+    }
+    cairo_restore(cr);
 
-        entry_y += FOREST_LAUNCHER_ENTRY_HEIGHT;
-        ++index;
+    const double content = count > 0 ? (count - 1) * geometry.entry_pitch + geometry.entry_height : 0.0;
+    if (content > geometry.rows_height && geometry.rows_height > 0.0) {
+        const double thumb = std::max(24.0, geometry.rows_height * geometry.rows_height / content);
+        const double travel = geometry.rows_height - thumb;
+        const double offset = travel * launcher_clamp_scroll(geometry, count, scroll) / (content - geometry.rows_height);
+        cairo_save(cr);
+        draw_rounded_rect(cr, start_x + panel_width - 14.0, geometry.entry_y + offset, 4.0, thumb, 2.0);
+        set_source_color(cr, ui.panel_text, 0.25f * opacity);
+        cairo_fill(cr);
+        cairo_restore(cr);
     }
 
     apply_font(server->pango_layout, SwissDesign::SECONDARY_FONT, 9);
@@ -395,10 +524,47 @@ void render_volume_overlay(cairo_t *cr, ArolloaServer *server, int width, int he
                      lighten(server->ui_state.panel_text, 0.4f), opacity * visibility);
 }
 
+// Sizes the shared overlay surface for an output.
+void size_ui_surface(ArolloaServer *server, int width, int height) {
+    int surface_width = cairo_image_surface_get_width(server->ui_surface);
+    int surface_height = cairo_image_surface_get_height(server->ui_surface);
+
+    if (surface_width != width || surface_height != height) {
+        cairo_destroy(server->cairo_ctx);
+        cairo_surface_destroy(server->ui_surface);
+        server->ui_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        server->cairo_ctx = cairo_create(server->ui_surface);
+    }
+}
+
+// Sizes the shared overlay surface for an output and clears it.
+void clear_ui_surface(ArolloaServer *server, int width, int height) {
+    size_ui_surface(server, width, height);
+    cairo_save(server->cairo_ctx);
+    cairo_set_operator(server->cairo_ctx, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_rgba(server->cairo_ctx, 0, 0, 0, 0);
+    cairo_paint(server->cairo_ctx);
+    cairo_restore(server->cairo_ctx);
+}
+
+// The overlay over a fullscreen view: notifications and the volume popup.
+void draw_fullscreen_ui(cairo_t *cr, ArolloaServer *server, int width, int height) {
+    render_notifications(cr, server, width, 1.0f);
+    render_volume_overlay(cr, server, width, height, 1.0f);
+}
+
+void render_fullscreen_ui(ArolloaServer *server, ArolloaOutput *output) {
+    int width = 0;
+    int height = 0;
+    wlr_output_effective_resolution(output->wlr_output, &width, &height);
+    clear_ui_surface(server, width, height);
+    draw_fullscreen_ui(server->cairo_ctx, server, width, height);
+    cairo_surface_flush(server->ui_surface);
+}
 } // namespace
 
-void render_swiss_panel(cairo_t *cairo, int width, int height, float opacity, const ArolloaServer *server) {
-    (void)height;
+void render_swiss_panel(cairo_t *cairo, const ChromeLayout &layout, float opacity, const ArolloaServer *server) {
+    const int width = layout.layout_box.width;
     cairo_save(cairo);
     cairo_rectangle(cairo, 0, 0, width, SwissDesign::PANEL_HEIGHT);
     set_source_color(cairo, server->ui_state.panel_base, opacity);
@@ -421,8 +587,8 @@ void render_swiss_panel(cairo_t *cairo, int width, int height, float opacity, co
     cairo_restore(cairo);
 
     draw_panel_branding(cairo, server, opacity);
-    draw_panel_apps(cairo, server, opacity);
-    draw_tray_icons(cairo, server, width, opacity);
+    draw_panel_apps(cairo, server, layout, opacity);
+    draw_tray_icons(cairo, server, layout, opacity);
     draw_panel_debug(cairo, server, width, opacity);
 }
 
@@ -435,9 +601,11 @@ void render_swiss_window(cairo_t *cairo, ArolloaView *view, float global_opacity
         return;
     }
 
-    const int width = view->xdg_surface->surface->current.width;
-    const int height = view->xdg_surface->surface->current.height;
-    if (width <= 0 || height <= 0) {
+    // The view size, not the surface's, so frames stay put while a layout
+    // transaction holds the old buffer.
+    const int width = view->width;
+    const int height = view->height;
+    if (!draws_chrome(view) || view->awaiting_layout || view->hidden || width <= 0 || height <= 0) {
         return;
     }
 
@@ -446,18 +614,20 @@ void render_swiss_window(cairo_t *cairo, ArolloaView *view, float global_opacity
         return;
     }
 
-    const double header_height = 34.0;
+    const double header_height = WINDOW_HEADER_HEIGHT;
     const double shadow_radius = SwissDesign::CORNER_RADIUS + 6.0;
-    const double frame_x = view->x - 8.0;
-    const double frame_y = view->y - header_height - 10.0;
-    const double frame_width = width + 16.0;
-    const double frame_height = header_height + height + 18.0;
+    const double frame_x = view->x - WINDOW_FRAME_MARGIN;
+    const double frame_y = view->y - header_height - WINDOW_FRAME_TOP_GAP;
+    const double frame_width = width + 2.0 * WINDOW_FRAME_MARGIN;
+    const double frame_height = header_height + height + WINDOW_FRAME_TOP_GAP + WINDOW_FRAME_MARGIN;
 
-    cairo_save(cairo);
-    draw_rounded_rect(cairo, frame_x, frame_y, frame_width, frame_height, shadow_radius);
-    set_source_color(cairo, SwissDesign::BLACK, 0.14f * opacity);
-    cairo_fill(cairo);
-    cairo_restore(cairo);
+    if (quality_draws_shadows(view->server)) {
+        cairo_save(cairo);
+        draw_rounded_rect(cairo, frame_x, frame_y, frame_width, frame_height, shadow_radius);
+        set_source_color(cairo, SwissDesign::BLACK, 0.14f * opacity);
+        cairo_fill(cairo);
+        cairo_restore(cairo);
+    }
 
     cairo_save(cairo);
     const double chrome_x = view->x - 2.0;
@@ -468,9 +638,14 @@ void render_swiss_window(cairo_t *cairo, ArolloaView *view, float global_opacity
     cairo_fill(cairo);
     cairo_restore(cairo);
 
+    // The accent rule marks the window with keyboard focus.
     cairo_save(cairo);
     cairo_rectangle(cairo, chrome_x, chrome_y, chrome_width, 3.0);
-    set_source_color(cairo, view->server->ui_state.accent_color, opacity * 0.9f);
+    if (view == view->server->focused_view) {
+        set_source_color(cairo, view->server->ui_state.accent_color, opacity * 0.9f);
+    } else {
+        set_source_color(cairo, lighten(view->server->ui_state.panel_text, 0.6f), opacity * 0.6f);
+    }
     cairo_fill(cairo);
     cairo_restore(cairo);
 
@@ -503,39 +678,127 @@ void render_swiss_window(cairo_t *cairo, ArolloaView *view, float global_opacity
     cairo_restore(cairo);
 }
 
-void render_swiss_ui(ArolloaServer *server, ArolloaOutput *output) {
-    int width = 0;
-    int height = 0;
-    wlr_output_effective_resolution(output->wlr_output, &width, &height);
+// Matches the header geometry drawn by render_swiss_window; the close
+// control is the accent-coloured one on the right.
+DecorationHit view_decoration_hit(const ArolloaView *view, double lx, double ly) {
+    if (!draws_chrome(view)) {
+        return DecorationHit::NONE;
+    }
 
-    int surface_width = cairo_image_surface_get_width(server->ui_surface);
-    int surface_height = cairo_image_surface_get_height(server->ui_surface);
+    const double chrome_x = view->x - 2.0;
+    const double chrome_y = view->y - WINDOW_HEADER_HEIGHT;
+    const double chrome_width = view->width + 4.0;
+    if (lx < chrome_x || lx >= chrome_x + chrome_width || ly < chrome_y || ly >= view->y) {
+        return DecorationHit::NONE;
+    }
 
-    if (surface_width != width || surface_height != height) {
-        cairo_destroy(server->cairo_ctx);
-        cairo_surface_destroy(server->ui_surface);
-        server->ui_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-        server->cairo_ctx = cairo_create(server->ui_surface);
+    const double close_x = chrome_x + chrome_width - 28.0;
+    const double close_y = chrome_y + WINDOW_HEADER_HEIGHT / 2.0 + 2.0;
+    const double dx = lx - close_x;
+    const double dy = ly - close_y;
+    if (dx * dx + dy * dy <= WINDOW_CONTROL_HIT_RADIUS * WINDOW_CONTROL_HIT_RADIUS) {
+        return DecorationHit::CLOSE;
     }
+    return DecorationHit::TITLEBAR;
+}
 
-    cairo_save(server->cairo_ctx);
-    cairo_set_operator(server->cairo_ctx, CAIRO_OPERATOR_SOURCE);
-    cairo_set_source_rgba(server->cairo_ctx, 0, 0, 0, 0);
-    cairo_paint(server->cairo_ctx);
-    cairo_restore(server->cairo_ctx);
+void launcher_row_cache_clear(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    for (auto &row : server->launcher_rows.rows) {
+        cairo_surface_destroy(row.surface);
+    }
+    server->launcher_rows.rows.clear();
+}
+
+// Layout box covering a view and everything drawn around it. Clients that
+// decorate themselves get no frame.
+struct wlr_box view_frame_box(const ArolloaView *view) {
+    if (!draws_chrome(view)) {
+        return {.x = view->x, .y = view->y, .width = view->width, .height = view->height};
+    }
+    const int top = static_cast<int>(WINDOW_HEADER_HEIGHT + WINDOW_FRAME_TOP_GAP);
+    const int margin = static_cast<int>(WINDOW_FRAME_MARGIN);
+    return {
+        .x = view->x - margin,
+        .y = view->y - top,
+        .width = view->width + 2 * margin,
+        .height = view->height + top + margin,
+    };
+}
+
+// Surface box that fits inside a frame box; the inverse of view_frame_box.
+struct wlr_box view_box_for_frame(const ArolloaView *view, const struct wlr_box &frame) {
+    if (!draws_chrome(view)) {
+        return frame;
+    }
+    const int top = static_cast<int>(WINDOW_HEADER_HEIGHT + WINDOW_FRAME_TOP_GAP);
+    const int margin = static_cast<int>(WINDOW_FRAME_MARGIN);
+    return {
+        .x = frame.x + margin,
+        .y = frame.y + top,
+        .width = frame.width - 2 * margin,
+        .height = frame.height - top - margin,
+    };
+}
+
+namespace {
+// Draws the panel, launcher, window chrome and popups for an output in
+// output-local coordinates, over whatever cr already holds.
+void draw_swiss_ui(cairo_t *cr, ArolloaServer *server, ArolloaOutput *output, int width, int height) {
+    const ChromeLayout *layout = chrome_layout_for(server, output);
+    if (layout && (layout->layout_box.width != width || layout->layout_box.height != height)) {
+        // Mode or scale changed before the layout change event reached us.
+        chrome_layout_invalidate(server);
+        layout = chrome_layout_for(server, output);
+    }
 
     const float opacity = std::clamp(server->startup_opacity, 0.0f, 1.0f);
-    render_swiss_panel(server->cairo_ctx, width, height, opacity, server);
-    render_launcher_overlay(server->cairo_ctx, server, width, height, opacity);
+    if (layout) {
+        render_swiss_panel(cr, *layout, opacity, server);
+        render_launcher_overlay(cr, server, *layout, opacity);
+    }
 
-    ArolloaView *decorated = nullptr;
-    wl_list_for_each(decorated, &server->views, link) {
-        render_swiss_window(server->cairo_ctx, decorated, opacity);
+    // The overview shows thumbnails instead of windows; only their titles
+    // belong to the overlay.
+    if (server->overview.visible) {
+        overview_draw_labels(cr, server);
+        render_notifications(cr, server, width, opacity);
+        render_volume_overlay(cr, server, width, height, opacity);
+        return;
     }
 
-    render_notifications(server->cairo_ctx, server, width, opacity);
-    render_volume_overlay(server->cairo_ctx, server, width, height, opacity);
+    // Window chrome is positioned in layout space; only frames that reach
+    // this output are drawn.
+    struct wlr_box output_box = {};
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+    cairo_save(cr);
+    cairo_translate(cr, -output_box.x, -output_box.y);
+    constexpr uint32_t decorated = RENDER_VISIBLE | RENDER_DECORATED;
+    for (const auto &record : server->render_list.records) {
+        if ((record.flags & decorated) != decorated) {
+            continue;
+        }
+        const struct wlr_box frame = view_frame_box(record.view);
+        struct wlr_box overlap = {};
+        if (wlr_box_intersection(&overlap, &frame, &output_box)) {
+            render_swiss_window(cr, record.view, opacity);
+        }
+    }
+    cairo_restore(cr);
 
+    render_notifications(cr, server, width, opacity);
+    render_volume_overlay(cr, server, width, height, opacity);
+}
+} // namespace
+
+void render_swiss_ui(ArolloaServer *server, ArolloaOutput *output) {
+    int width = 0;
+    int height = 0;
+    wlr_output_effective_resolution(output->wlr_output, &width, &height);
+    clear_ui_surface(server, width, height);
+    draw_swiss_ui(server->cairo_ctx, server, output, width, height);
     cairo_surface_flush(server->ui_surface);
 }
 
@@ -561,14 +824,13 @@ void initialize_forest_ui(ArolloaServer *server) {
         {"PWR", "Power status", SwissDesign::Forest::BARK}
     };
 
-    server->ui_state.launcher_entries = {
-        {"Forest Terminal", "foot", "A minimalist Wayland terminal optimized for clarity.", "System"},
-        {"Web Browser", "firefox", "Launch a modern browser with privacy enhancements.", "Internet"},
-        {"File Manager", "thunar", "Browse the Swiss filesystem with precision.", "Productivity"},
-        {"Settings", "./build/arolloa-settings", "Configure the compositor without GTK dependencies.", "Control"},
-        {"Flatpak Manager", "flatpak run com.valvesoftware.Steam", "Access packaged applications and games.", "Apps"},
-        {"System Monitor", "gnome-system-monitor", "Inspect processes and resource utilization.", "Diagnostics"}
+    // Installed applications are appended by the application catalog.
+    server->ui_state.builtin_entries = {
+        {"Settings", "./build/arolloa-settings", "Configure the compositor without GTK dependencies.", "Control"}
     };
+    server->ui_state.launcher_entries = server->ui_state.builtin_entries;
+    server->ui_state.launcher_query.clear();
+    launcher_search_rebuild(server);
 
     server->ui_state.launcher_visible = false;
     server->ui_state.highlighted_index = 0;
@@ -578,39 +840,45 @@ void initialize_forest_ui(ArolloaServer *server) {
     server->ui_state.volume_feedback.target_visibility = 0.0f;
 }
 
-void output_frame(struct wl_listener *listener, void *data) {
-    (void)data;
-    ArolloaOutput *output = wl_container_of(listener, output, frame);
-    ArolloaServer *server = output->server;
-
-    const struct timespec now = get_monotonic_time();
-
-    int width = 0;
-    int height = 0;
-    wlr_output_effective_resolution(output->wlr_output, &width, &height);
-
-    const float fade = std::clamp(server->startup_opacity, 0.0f, 1.0f);
-
-    struct wlr_output_state state;
-    wlr_output_state_init(&state);
-
-    struct wlr_render_pass *render_pass = wlr_output_begin_render_pass(output->wlr_output, &state, nullptr, nullptr);
-    if (!render_pass) {
-        wlr_output_state_finish(&state);
+namespace {
+// Software seats fill straight into the output buffer with pixman's solid
+// fill, which has SIMD fast paths, and only inside the repaint region.
+void add_background_rect(struct wlr_render_pass *render_pass, pixman_image_t *direct, const pixman_region32_t *repaint,
+                         const struct wlr_box &box, const struct wlr_render_color &color) {
+    if (!direct) {
+        struct wlr_render_rect_options rect = {};
+        rect.box = box;
+        rect.color = color;
+        wlr_render_pass_add_rect(render_pass, &rect);
         return;
     }
 
+    pixman_region32_t fill;
+    pixman_region32_init(&fill);
+    pixman_region32_intersect_rect(&fill, repaint, box.x, box.y, box.width, box.height);
+    int count = 0;
+    const pixman_box32_t *boxes = pixman_region32_rectangles(&fill, &count);
+    const pixman_color_t pixel = {
+        .red = static_cast<uint16_t>(color.r * 0xffff),
+        .green = static_cast<uint16_t>(color.g * 0xffff),
+        .blue = static_cast<uint16_t>(color.b * 0xffff),
+        .alpha = static_cast<uint16_t>(color.a * 0xffff),
+    };
+    pixman_image_fill_boxes(color.a >= 1.0f ? PIXMAN_OP_SRC : PIXMAN_OP_OVER, direct, &pixel, count, boxes);
+    pixman_region32_fini(&fill);
+}
+
+void render_background(struct wlr_render_pass *render_pass, pixman_image_t *direct, const pixman_region32_t *repaint,
+                       int width, int height, float fade) {
     const struct wlr_box top_box = {
         .x = 0,
         .y = 0,
         .width = width,
         .height = height / 2,
     };
-    struct wlr_render_rect_options top_rect = {};
-    top_rect.box = top_box;
     auto top_color = lerp_color(SwissDesign::Forest::CANOPY_DARK, SwissDesign::Forest::CANOPY_MID, fade);
-    top_rect.color = {.r = top_color.r * fade, .g = top_color.g * fade, .b = top_color.b * fade, .a = fade};
-    wlr_render_pass_add_rect(render_pass, &top_rect);
+    add_background_rect(render_pass, direct, repaint, top_box,
+                        {.r = top_color.r * fade, .g = top_color.g * fade, .b = top_color.b * fade, .a = fade});
 
     const struct wlr_box bottom_box = {
         .x = 0,
@@ -618,11 +886,10 @@ void output_frame(struct wl_listener *listener, void *data) {
         .width = width,
         .height = height - height / 2,
     };
-    struct wlr_render_rect_options bottom_rect = {};
-    bottom_rect.box = bottom_box;
     auto bottom_color = lerp_color(SwissDesign::Forest::CANOPY_MID, SwissDesign::Forest::CANOPY_LIGHT, fade);
-    bottom_rect.color = {.r = bottom_color.r * fade, .g = bottom_color.g * fade, .b = bottom_color.b * fade, .a = fade};
-    wlr_render_pass_add_rect(render_pass, &bottom_rect);
+    add_background_rect(render_pass, direct, repaint, bottom_box,
+                        {.r = bottom_color.r * fade, .g = bottom_color.g * fade, .b = bottom_color.b * fade,
+                         .a = fade});
 
     const struct wlr_box panel_box = {
         .x = 0,
@@ -631,69 +898,490 @@ void output_frame(struct wl_listener *listener, void *data) {
         .height = SwissDesign::PANEL_HEIGHT
     };
 
-    struct wlr_render_rect_options panel_rect = {};
-    panel_rect.box = panel_box;
     auto panel_color = lerp_color(SwissDesign::Forest::CANOPY_DARK, SwissDesign::Forest::CANOPY_LIGHT, 0.35f);
-    panel_rect.color = {.r = panel_color.r * fade, .g = panel_color.g * fade, .b = panel_color.b * fade, .a = fade};
-    wlr_render_pass_add_rect(render_pass, &panel_rect);
+    add_background_rect(render_pass, direct, repaint, panel_box,
+                        {.r = panel_color.r * fade, .g = panel_color.g * fade, .b = panel_color.b * fade, .a = fade});
+}
 
-    animation_tick(server);
+// A fullscreen view on top of everything else on the output, drawn at full
+// opacity with nothing Arolloa needs to show over it, or nullptr.
+const RenderRecord *fullscreen_record(ArolloaServer *server, ArolloaOutput *output, const struct wlr_box &output_box) {
+    const ArolloaView *view = output->fullscreen_view;
+    if (!view || view->render_slot == 0 || server->ui_state.launcher_visible || server->overview.visible ||
+        server->startup_opacity < 1.0f) {
+        return nullptr;
+    }
+
+    const auto &records = server->render_list.records;
+    const RenderRecord &record = records[view->render_slot - 1];
+    if (!(record.flags & RENDER_VISIBLE) || !record.texture || record.opacity < 1.0f) {
+        return nullptr;
+    }
+    for (std::size_t i = view->render_slot; i < records.size(); ++i) {
+        struct wlr_box overlap = {};
+        if ((records[i].flags & RENDER_VISIBLE) && wlr_box_intersection(&overlap, &records[i].box, &output_box)) {
+            return nullptr;
+        }
+    }
+    return &record;
+}
+
+// Whether the surface's opaque region hides the whole output.
+bool surface_covers_output(const RenderRecord &record, const struct wlr_box &output_box) {
+    struct wlr_box covered = {};
+    if (!wlr_box_intersection(&covered, &record.box, &output_box) || !wlr_box_equal(&covered, &output_box)) {
+        return false;
+    }
+    pixman_box32_t rect = {
+        .x1 = output_box.x - record.box.x,
+        .y1 = output_box.y - record.box.y,
+        .x2 = output_box.x - record.box.x + output_box.width,
+        .y2 = output_box.y - record.box.y + output_box.height,
+    };
+    return pixman_region32_contains_rectangle(&record.surface->opaque_region, &rect) == PIXMAN_REGION_IN;
+}
+
+// Software rendering seats draw the UI straight into the output buffer.
+// Scaled or rotated outputs keep the overlay texture, which wlroots
+// transforms for us.
+bool software_direct_ui(ArolloaServer *server, ArolloaOutput *output) {
+    return !output->direct_ui_failed && wlr_renderer_is_pixman(server->renderer) &&
+           output->wlr_output->scale == 1.0f && output->wlr_output->transform == WL_OUTPUT_TRANSFORM_NORMAL;
+}
+
+// The pixman image behind the buffer being rendered, if Cairo can draw to
+// it. The pixman renderer composites as each pass operation is added, so
+// the image already holds the views when the UI is drawn over them.
+pixman_image_t *direct_ui_target(ArolloaServer *server, ArolloaOutput *output, struct wlr_buffer *buffer) {
+    pixman_image_t *image = buffer ? wlr_pixman_renderer_get_buffer_image(server->renderer, buffer) : nullptr;
+    if (image) {
+        const pixman_format_code_t format = pixman_image_get_format(image);
+        if (format == PIXMAN_a8r8g8b8 || format == PIXMAN_x8r8g8b8) {
+            return image;
+        }
+    }
+
+    wlr_log(WLR_INFO, "Output %s: buffer is not Cairo-compatible, using the overlay texture",
+            output->wlr_output->name);
+    output->direct_ui_failed = true;
+    wlr_damage_ring_add_whole(&output->damage_ring);
+    return nullptr;
+}
+
+void draw_ui_direct(ArolloaServer *server, ArolloaOutput *output, pixman_image_t *image,
+                    const pixman_region32_t &repaint, bool fullscreen, int width, int height) {
+    if (!pixman_region32_not_empty(&repaint)) {
+        return;
+    }
 
-    ArolloaView *view = nullptr;
-    wl_list_for_each(view, &server->views, link) {
-        if (!view->mapped) {
+    const cairo_format_t format =
+        pixman_image_get_format(image) == PIXMAN_a8r8g8b8 ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24;
+    cairo_surface_t *surface = cairo_image_surface_create_for_data(
+        reinterpret_cast<unsigned char *>(pixman_image_get_data(image)), format, pixman_image_get_width(image),
+        pixman_image_get_height(image), pixman_image_get_stride(image));
+    cairo_t *cr = cairo_create(surface);
+
+    int count = 0;
+    const pixman_box32_t *boxes = pixman_region32_rectangles(&repaint, &count);
+    for (int i = 0; i < count; ++i) {
+        cairo_rectangle(cr, boxes[i].x1, boxes[i].y1, boxes[i].x2 - boxes[i].x1, boxes[i].y2 - boxes[i].y1);
+    }
+    cairo_clip(cr);
+
+    if (fullscreen) {
+        draw_fullscreen_ui(cr, server, width, height);
+    } else {
+        draw_swiss_ui(cr, server, output, width, height);
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    cairo_surface_destroy(surface);
+}
+
+// The shared Cairo overlay surface as a read-only wlroots buffer, so part of
+// it can be copied into an existing overlay texture.
+struct OverlayBuffer {
+    struct wlr_buffer base;
+    cairo_surface_t *surface;
+};
+
+bool overlay_buffer_begin_access(struct wlr_buffer *buffer, uint32_t flags, void **data, uint32_t *format,
+                                 size_t *stride) {
+    if (flags & WLR_BUFFER_DATA_PTR_ACCESS_WRITE) {
+        return false;
+    }
+    OverlayBuffer *overlay = wl_container_of(buffer, overlay, base);
+    *data = cairo_image_surface_get_data(overlay->surface);
+    *format = DRM_FORMAT_ARGB8888;
+    *stride = static_cast<size_t>(cairo_image_surface_get_stride(overlay->surface));
+    return true;
+}
+
+// Overlay buffers live on the stack of update_ui_texture.
+const struct wlr_buffer_impl OVERLAY_BUFFER_IMPL = {
+    .destroy = [](struct wlr_buffer *) {},
+    .get_dmabuf = nullptr,
+    .get_shm = nullptr,
+    .begin_data_ptr_access = overlay_buffer_begin_access,
+    .end_data_ptr_access = [](struct wlr_buffer *) {},
+};
+
+// Redraws only the damaged part of the overlay and copies just that part
+// into the output's texture. Returns false if the texture cannot be updated
+// in place and has to be uploaded whole.
+bool update_ui_texture(ArolloaServer *server, ArolloaOutput *output, bool fullscreen, int width, int height) {
+    if (output->ui_texture->width != static_cast<uint32_t>(width) ||
+        output->ui_texture->height != static_cast<uint32_t>(height)) {
+        return false;
+    }
+
+    pixman_region32_t damage;
+    pixman_region32_init(&damage);
+    pixman_region32_intersect_rect(&damage, &output->ui_damage, 0, 0, width, height);
+    if (!pixman_region32_not_empty(&damage)) {
+        pixman_region32_fini(&damage);
+        return true;
+    }
+
+    // The surface is shared between outputs, so outside the damage it may
+    // hold another output's overlay; none of that is copied.
+    size_ui_surface(server, width, height);
+    cairo_t *cr = server->cairo_ctx;
+    cairo_save(cr);
+    int count = 0;
+    const pixman_box32_t *boxes = pixman_region32_rectangles(&damage, &count);
+    for (int i = 0; i < count; ++i) {
+        cairo_rectangle(cr, boxes[i].x1, boxes[i].y1, boxes[i].x2 - boxes[i].x1, boxes[i].y2 - boxes[i].y1);
+    }
+    cairo_clip(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_rgba(cr, 0, 0, 0, 0);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    if (fullscreen) {
+        draw_fullscreen_ui(cr, server, width, height);
+    } else {
+        draw_swiss_ui(cr, server, output, width, height);
+    }
+    cairo_restore(cr);
+    cairo_surface_flush(server->ui_surface);
+
+    OverlayBuffer buffer = {};
+    buffer.surface = server->ui_surface;
+    wlr_buffer_init(&buffer.base, &OVERLAY_BUFFER_IMPL, width, height);
+    const bool updated = wlr_texture_update_from_buffer(output->ui_texture, &buffer.base, &damage);
+    wlr_buffer_drop(&buffer.base);
+    pixman_region32_fini(&damage);
+    return updated;
+}
+
+// Over a fullscreen view only notifications and the volume popup are drawn.
+bool fullscreen_overlay_visible(const ArolloaServer *server) {
+    return !server->ui_state.notifications.empty() || server->ui_state.volume_feedback.visibility > 0.0f;
+}
+
+// Hands the frame's damage to the backend in buffer coordinates. The damage
+// ring collects it in layout units local to the output, which differ on
+// scaled or rotated outputs.
+void set_frame_damage(struct wlr_output_state *state, ArolloaOutput *output, bool whole) {
+    struct wlr_output *wlr_output = output->wlr_output;
+    int width = 0;
+    int height = 0;
+    wlr_output_transformed_resolution(wlr_output, &width, &height);
+
+    pixman_region32_t damage;
+    pixman_region32_init(&damage);
+    if (whole) {
+        pixman_region32_union_rect(&damage, &damage, 0, 0, width, height);
+    } else {
+        wlr_region_scale(&damage, &output->damage_ring.current, wlr_output->scale);
+        pixman_region32_intersect_rect(&damage, &damage, 0, 0, width, height);
+    }
+    wlr_region_transform(&damage, &damage, wlr_output_transform_invert(wlr_output->transform), width, height);
+    wlr_output_state_set_damage(state, &damage);
+    pixman_region32_fini(&damage);
+}
+
+void damage_whole(ArolloaServer *server) {
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        wlr_damage_ring_add_whole(&output->damage_ring);
+    }
+}
+} // namespace
+
+// The Cairo overlay does not track what changed inside it, so UI changes
+// damage whole outputs unless the caller knows the affected region.
+void mark_ui_dirty(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    ++server->ui_generation;
+    damage_whole(server);
+    schedule_output_frames(server);
+}
+
+void mark_content_dirty(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    ++server->content_generation;
+    damage_whole(server);
+    schedule_output_frames(server);
+}
+
+// Both UI and content changed, but only inside the given layout box.
+// Outputs whose overlay was up to date only redraw that box of it.
+void mark_region_dirty(ArolloaServer *server, const struct wlr_box &box) {
+    if (!server) {
+        return;
+    }
+    const uint64_t previous = server->ui_generation++;
+    ++server->content_generation;
+
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        struct wlr_box output_box = {};
+        wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+        struct wlr_box local = box;
+        local.x -= output_box.x;
+        local.y -= output_box.y;
+        if (output->ui_generation == previous) {
+            output->ui_generation = server->ui_generation;
+            pixman_region32_union_rect(&output->ui_damage, &output->ui_damage, local.x, local.y, local.width,
+                                       local.height);
+        }
+        if (wlr_damage_ring_add_box(&output->damage_ring, &local) && server->initialized) {
+            wlr_output_schedule_frame(output->wlr_output);
+        }
+    }
+}
+
+// A client commit only damages what the client reported as changed.
+void damage_view_commit(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    ++server->content_generation;
+    switcher_damage(server);
+    if (server->overview.visible) {
+        // Thumbnails are scaled and laid out apart from the view, so the
+        // client's damage does not map onto them.
+        damage_whole(server);
+        schedule_output_frames(server);
+        return;
+    }
+
+    pixman_region32_t damage;
+    pixman_region32_init(&damage);
+    wlr_surface_get_effective_damage(view->xdg_surface->surface, &damage);
+
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        struct wlr_box output_box = {};
+        wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+        const int dx = view->x - output_box.x;
+        const int dy = view->y - output_box.y;
+        pixman_region32_translate(&damage, dx, dy);
+        if (wlr_damage_ring_add(&output->damage_ring, &damage) && server->initialized) {
+            wlr_output_schedule_frame(output->wlr_output);
+        }
+        pixman_region32_translate(&damage, -dx, -dy);
+    }
+    pixman_region32_fini(&damage);
+}
+
+void schedule_output_frames(ArolloaServer *server) {
+    if (!server || !server->initialized) {
+        return;
+    }
+
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        wlr_output_schedule_frame(output->wlr_output);
+    }
+}
+
+void output_frame(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaOutput *output = wl_container_of(listener, output, frame);
+    ArolloaServer *server = output->server;
+
+    const struct timespec now = get_monotonic_time();
+
+    // Backstop for pointer devices that never send a frame event.
+    flush_pointer_motion(server);
+    // Animated UI only bumps the overlay generation; the software path
+    // repaints no more than the damage, so the outputs are damaged whole.
+    if (animation_tick(server)) {
+        damage_whole(server);
+    }
+
+    // A fullscreen view covering the output replaces the background, the
+    // panel, the overlay and every view below it.
+    struct wlr_box output_box = {};
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+    const RenderRecord *fullscreen = fullscreen_record(server, output, output_box);
+    const bool overlay = !fullscreen || fullscreen_overlay_visible(server);
+    const bool direct_ui = software_direct_ui(server, output);
+    bool ui_changed = overlay && ((!direct_ui && !output->ui_texture) ||
+                                  output->ui_generation != server->ui_generation ||
+                                  output->ui_fullscreen != (fullscreen != nullptr));
+    const bool content_changed = output->content_generation != server->content_generation;
+    if (server->motion.low_power && !ui_changed && !content_changed) {
+        // Nothing new to present: let the output idle until a client commits
+        // or the next capped UI tick is due.
+        schedule_ui_tick(server);
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    wlr_output_effective_resolution(output->wlr_output, &width, &height);
+    wlr_damage_ring_set_bounds(&output->damage_ring, width, height);
+
+    const float fade = std::clamp(server->startup_opacity, 0.0f, 1.0f);
+
+    // Thumbnails are drawn in render passes of their own, which cannot
+    // nest inside the output's.
+    thumbnail_begin_frame(server);
+    if (server->overview.visible) {
+        overview_prepare(server, output);
+    }
+    switcher_prepare(server, output);
+
+    struct wlr_output_state state;
+    wlr_output_state_init(&state);
+
+    int buffer_age = -1;
+    struct wlr_render_pass *render_pass =
+        wlr_output_begin_render_pass(output->wlr_output, &state, &buffer_age, nullptr);
+    if (!render_pass) {
+        wlr_output_state_finish(&state);
+        return;
+    }
+
+    // On the pixman renderer only the part of the buffer that is out of
+    // date gets repainted, UI included; elsewhere the frame is drawn whole.
+    pixman_image_t *direct = direct_ui ? direct_ui_target(server, output, state.buffer) : nullptr;
+    pixman_region32_t repaint;
+    pixman_region32_init(&repaint);
+    if (direct) {
+        wlr_damage_ring_get_buffer_damage(&output->damage_ring, buffer_age, &repaint);
+    } else if (direct_ui) {
+        ui_changed = overlay;
+    }
+    const pixman_region32_t *clip = direct ? &repaint : nullptr;
+    bool overlay_uploaded = false;
+
+    if (!fullscreen) {
+        render_background(render_pass, direct, clip, width, height, fade);
+    } else if (!surface_covers_output(*fullscreen, output_box)) {
+        // Letterboxed or translucent fullscreen clients get black bars.
+        add_background_rect(render_pass, direct, clip, {.x = 0, .y = 0, .width = width, .height = height},
+                            {.r = 0.0f, .g = 0.0f, .b = 0.0f, .a = 1.0f});
+    }
+
+    // Only the render records are touched here, never the views themselves.
+    // Views are translated into output space and culled against it.
+    for (const auto &record : server->render_list.records) {
+        if (!(record.flags & RENDER_VISIBLE) || !record.texture || (fullscreen && &record != fullscreen)) {
             continue;
         }
-        struct wlr_surface *surface = view->xdg_surface->surface;
-        struct wlr_texture *texture = wlr_surface_get_texture(surface);
-        if (!texture) {
+        struct wlr_box overlap = {};
+        if (!wlr_box_intersection(&overlap, &record.box, &output_box)) {
             continue;
         }
 
-        const float alpha = std::clamp(view->opacity * fade, 0.0f, 1.0f);
+        const float alpha = std::clamp(record.opacity * fade, 0.0f, 1.0f);
         if (alpha <= 0.0f) {
             continue;
         }
 
-        const struct wlr_box box = {
-            .x = view->x,
-            .y = view->y,
-            .width = surface->current.width,
-            .height = surface->current.height
-        };
+        // Under the overview clients keep drawing, so their thumbnails stay
+        // live, but only the thumbnails reach the screen.
+        if (!server->overview.visible) {
+            struct wlr_render_texture_options texture_options = {};
+            texture_options.texture = record.texture;
+            texture_options.dst_box = record.box;
+            texture_options.dst_box.x -= output_box.x;
+            texture_options.dst_box.y -= output_box.y;
+            texture_options.clip = clip;
+            if (alpha < 1.0f) {
+                texture_options.alpha = &alpha;
+            }
+            wlr_render_pass_add_texture(render_pass, &texture_options);
+        }
 
-        struct wlr_render_texture_options texture_options = {};
-        texture_options.texture = texture;
-        texture_options.dst_box = box;
-        if (alpha < 1.0f) {
-            texture_options.alpha = &alpha;
+        if (record.frame_output == output) {
+            wlr_surface_send_frame_done(record.surface, &now);
         }
-        wlr_render_pass_add_texture(render_pass, &texture_options);
-
-        wlr_surface_send_frame_done(surface, &now);
-    }
-
-    render_swiss_ui(server, output);
-    struct wlr_texture *ui_texture = wlr_texture_from_pixels(server->renderer, DRM_FORMAT_ARGB8888,
-        cairo_image_surface_get_stride(server->ui_surface), width, height,
-        cairo_image_surface_get_data(server->ui_surface));
-    if (ui_texture) {
-        struct wlr_render_texture_options ui_options = {};
-        ui_options.texture = ui_texture;
-        ui_options.dst_box = {
-            .x = 0,
-            .y = 0,
-            .width = width,
-            .height = height,
-        };
-        wlr_render_pass_add_texture(render_pass, &ui_options);
-        wlr_texture_destroy(ui_texture);
+    }
+    if (server->overview.visible) {
+        overview_render(server, render_pass, clip);
     }
 
+    if (direct) {
+        // Software seats rasterise the UI straight into the buffer; there is
+        // no overlay texture to upload and blend.
+        if (overlay) {
+            draw_ui_direct(server, output, direct, repaint, fullscreen != nullptr, width, height);
+        }
+        if (output->ui_texture) {
+            wlr_texture_destroy(output->ui_texture);
+            output->ui_texture = nullptr;
+        }
+        output->ui_generation = server->ui_generation;
+        output->ui_fullscreen = fullscreen != nullptr;
+        pixman_region32_clear(&output->ui_damage);
+    } else {
+        // The Cairo overlay is only re-rasterised and uploaded whole when the
+        // UI generation moved; damaged boxes are redrawn and updated in place.
+        // Otherwise the cached texture is composited as-is.
+        if (!ui_changed && overlay && output->ui_texture && pixman_region32_not_empty(&output->ui_damage)) {
+            ui_changed = !update_ui_texture(server, output, fullscreen != nullptr, width, height);
+            pixman_region32_clear(&output->ui_damage);
+        }
+        if (ui_changed) {
+            if (fullscreen) {
+                render_fullscreen_ui(server, output);
+            } else {
+                render_swiss_ui(server, output);
+            }
+            if (output->ui_texture) {
+                wlr_texture_destroy(output->ui_texture);
+            }
+            output->ui_texture = wlr_texture_from_pixels(server->renderer, DRM_FORMAT_ARGB8888,
+                cairo_image_surface_get_stride(server->ui_surface), width, height,
+                cairo_image_surface_get_data(server->ui_surface));
+            output->ui_generation = server->ui_generation;
+            output->ui_fullscreen = fullscreen != nullptr;
+            overlay_uploaded = true;
+            pixman_region32_clear(&output->ui_damage);
+        }
+
+        if (overlay && output->ui_texture) {
+            struct wlr_render_texture_options ui_options = {};
+            ui_options.texture = output->ui_texture;
+            ui_options.dst_box = {
+                .x = 0,
+                .y = 0,
+                .width = width,
+                .height = height,
+            };
+            wlr_render_pass_add_texture(render_pass, &ui_options);
+        }
+    }
+    switcher_render(server, output, render_pass, clip);
+    pixman_region32_fini(&repaint);
+
     if (!wlr_render_pass_submit(render_pass)) {
         wlr_output_state_finish(&state);
         return;
     }
+    // Outside the software path the frame is still repainted in full; the
+    // damage lets the backend limit scanout updates and plane uploads to
+    // what actually changed. A wholly re-uploaded overlay may differ anywhere.
+    set_frame_damage(&state, output, overlay_uploaded);
 
     if (!wlr_output_commit_state(output->wlr_output, &state)) {
         wlr_output_state_finish(&state);
@@ -701,6 +1389,14 @@ void output_frame(struct wl_listener *listener, void *data) {
     }
 
     wlr_output_state_finish(&state);
+    wlr_damage_ring_rotate(&output->damage_ring);
+    output->content_generation = server->content_generation;
+    latency_trace_output_commit(server, output);
+
+    const struct timespec done = get_monotonic_time();
+    const float frame_ms = (done.tv_sec - now.tv_sec) * 1000.0f + (done.tv_nsec - now.tv_nsec) / 1e6f;
+    quality_governor_record_frame(server, output, frame_ms);
+    output->last_frame = now;
 }
 
 namespace {
@@ -710,6 +1406,7 @@ void remove_output_listeners(ArolloaOutput *output) {
     }
 
     wl_list_remove(&output->frame.link);
+    wl_list_remove(&output->present.link);
 #if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (17 << 8) | 0)
     wl_list_remove(&output->request_state.link);
 #endif
@@ -766,10 +1463,28 @@ void server_new_output(struct wl_listener *listener, void *data) {
     output->wlr_output = wlr_output;
     output->server = server;
     output->last_frame = get_monotonic_time();
+    wlr_damage_ring_init(&output->damage_ring);
+    pixman_region32_init(&output->ui_damage);
 
     output->frame.notify = output_frame;
     wl_signal_add(&wlr_output->events.frame, &output->frame);
 
+    output->present.notify = [](struct wl_listener *listener, void *data) {
+        ArolloaOutput *output = wl_container_of(listener, output, present);
+        const auto *event = static_cast<const struct wlr_output_event_present *>(data);
+        const struct timespec *when = nullptr;
+        if (event && event->presented) {
+            // wlroots 0.18 turned the timestamp from a pointer into a value.
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+            when = &event->when;
+#else
+            when = event->when;
+#endif
+        }
+        latency_trace_output_present(output->server, output, when);
+    };
+    wl_signal_add(&wlr_output->events.present, &output->present);
+
 #if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (17 << 8) | 0)
     output->request_state.notify = output_request_state;
     wl_signal_add(&wlr_output->events.request_state, &output->request_state);
@@ -779,6 +1494,17 @@ void server_new_output(struct wl_listener *listener, void *data) {
         (void)data;
         ArolloaOutput *output = wl_container_of(listener, output, destroy);
         remove_output_listeners(output);
+        chrome_layout_forget(output->server, output);
+        tiling_forget_output(output->server, output);
+        fullscreen_forget_output(output->server, output);
+        switcher_forget_output(output->server, output);
+        render_list_outputs_changed(output->server);
+        latency_trace_forget_output(output->server, output);
+        wlr_damage_ring_finish(&output->damage_ring);
+        pixman_region32_fini(&output->ui_damage);
+        if (output->ui_texture) {
+            wlr_texture_destroy(output->ui_texture);
+        }
         free(output);
     };
     wl_signal_add(&wlr_output->events.destroy, &output->destroy);
@@ -0,0 +1,210 @@
+#include "../../include/arolloa.h"
+
+#include <wlr/render/pass.h>
+
+#include <cmath>
+
+namespace {
+constexpr int CELL_GAP = SwissDesign::GUTTER_WIDTH;
+constexpr int LABEL_HEIGHT = 22;
+
+// Splits a length into count spans separated by gap.
+int span_offset(int length, int count, int index) {
+    const int span = (length - (count - 1) * CELL_GAP) / count;
+    return index * (span + CELL_GAP);
+}
+
+// The largest box with the view's aspect ratio that fits the slot, centred
+// above the title line.
+struct wlr_box fit_into(const struct wlr_box &slot, int width, int height) {
+    const int available_height = std::max(slot.height - LABEL_HEIGHT, 1);
+    const double scale = std::min(static_cast<double>(slot.width) / std::max(width, 1),
+                                  static_cast<double>(available_height) / std::max(height, 1));
+    const int fitted_width = std::max(1, static_cast<int>(width * scale));
+    const int fitted_height = std::max(1, static_cast<int>(height * scale));
+    return {
+        .x = slot.x + (slot.width - fitted_width) / 2,
+        .y = slot.y + (available_height - fitted_height) / 2,
+        .width = fitted_width,
+        .height = fitted_height,
+    };
+}
+
+void close_overview(ArolloaServer *server) {
+    server->overview.visible = false;
+    server->overview.cells.clear();
+    cursor_rebase(server);
+    mark_ui_dirty(server);
+    mark_content_dirty(server);
+}
+} // namespace
+
+// Lays the output's visible windows out as a grid, bottom of the stack
+// first, in output-local coordinates. Textures are left for the caller.
+void overview_layout(ArolloaServer *server, ArolloaOutput *output, std::vector<OverviewState::Cell> &cells) {
+    cells.clear();
+    struct wlr_box output_box = {};
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+    struct wlr_box area = output_usable_area(server, output);
+    if (wlr_box_empty(&area)) {
+        return;
+    }
+    area.x -= output_box.x;
+    area.y -= output_box.y;
+
+    for (const auto &record : server->render_list.records) {
+        if ((record.flags & RENDER_VISIBLE) && record.frame_output == output) {
+            cells.push_back({.view = record.view, .box = record.box, .texture = nullptr});
+        }
+    }
+    if (cells.empty()) {
+        return;
+    }
+
+    const std::size_t count = cells.size();
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const int rows = static_cast<int>((count + columns - 1) / columns);
+    const int slot_width = (area.width - (columns - 1) * CELL_GAP) / columns;
+    const int slot_height = (area.height - (rows - 1) * CELL_GAP) / rows;
+    for (std::size_t i = 0; i < count; ++i) {
+        const int column = static_cast<int>(i) % columns;
+        const int row = static_cast<int>(i) / columns;
+        const struct wlr_box slot = {
+            .x = area.x + span_offset(area.width, columns, column),
+            .y = area.y + span_offset(area.height, rows, row),
+            .width = slot_width,
+            .height = slot_height,
+        };
+        cells[i].box = fit_into(slot, cells[i].box.width, cells[i].box.height);
+    }
+}
+
+// Lays out and fetches thumbnails for the output about to be drawn. Stale
+// thumbnails are redrawn here, so this runs before the output's render pass
+// is opened.
+void overview_prepare(ArolloaServer *server, ArolloaOutput *output) {
+    auto &cells = server->overview.cells;
+    overview_layout(server, output, cells);
+    bool pending = false;
+    for (auto &cell : cells) {
+        cell.texture = thumbnail_get(cell.view);
+        pending = pending || !cell.texture;
+    }
+    // Thumbnails over this frame's refresh budget are picked up next frame.
+    if (pending || server->thumbnails.refreshes_left == 0) {
+        wlr_output_schedule_frame(output->wlr_output);
+    }
+}
+
+void overview_render(ArolloaServer *server, struct wlr_render_pass *render_pass, const pixman_region32_t *clip) {
+    const SwissDesign::Color &panel = server->ui_state.panel_base;
+    for (const auto &cell : server->overview.cells) {
+        struct wlr_render_rect_options backdrop = {};
+        backdrop.box = {
+            .x = cell.box.x - 1,
+            .y = cell.box.y - 1,
+            .width = cell.box.width + 2,
+            .height = cell.box.height + 2,
+        };
+        backdrop.color = {.r = panel.r * 0.85f, .g = panel.g * 0.85f, .b = panel.b * 0.85f, .a = 1.0f};
+        backdrop.clip = clip;
+        wlr_render_pass_add_rect(render_pass, &backdrop);
+
+        if (!cell.texture) {
+            continue;
+        }
+        struct wlr_render_texture_options options = {};
+        options.texture = cell.texture;
+        options.dst_box = cell.box;
+        options.clip = clip;
+        options.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+        wlr_render_pass_add_texture(render_pass, &options);
+    }
+}
+
+// Window titles under the thumbnails, drawn with the UI overlay.
+void overview_draw_labels(cairo_t *cr, ArolloaServer *server) {
+    if (!server->pango_layout) {
+        return;
+    }
+
+    PangoLayout *layout = server->pango_layout;
+    PangoFontDescription *desc =
+        pango_font_description_from_string((std::string(SwissDesign::SECONDARY_FONT) + " 10").c_str());
+    pango_layout_set_font_description(layout, desc);
+    pango_font_description_free(desc);
+    pango_layout_set_alignment(layout, PANGO_ALIGN_LEFT);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+
+    const SwissDesign::Color &text = server->ui_state.panel_text;
+    for (const auto &cell : server->overview.cells) {
+        const struct wlr_xdg_toplevel *toplevel = cell.view->xdg_surface->toplevel;
+        const char *title = toplevel && toplevel->title ? toplevel->title : "Untitled";
+        pango_layout_set_width(layout, cell.box.width * PANGO_SCALE);
+        pango_layout_set_text(layout, title, -1);
+
+        cairo_save(cr);
+        cairo_move_to(cr, cell.box.x, cell.box.y + cell.box.height + 6.0);
+        if (cell.view == server->focused_view) {
+            const SwissDesign::Color &accent = server->ui_state.accent_color;
+            cairo_set_source_rgba(cr, accent.r, accent.g, accent.b, 1.0);
+        } else {
+            cairo_set_source_rgba(cr, text.r, text.g, text.b, 1.0);
+        }
+        pango_cairo_show_layout(cr, layout);
+        cairo_restore(cr);
+    }
+    pango_layout_set_width(layout, -1);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_NONE);
+}
+
+void overview_toggle(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    if (server->overview.visible) {
+        close_overview(server);
+        return;
+    }
+
+    server->overview.visible = true;
+    server->ui_state.launcher_visible = false;
+    cursor_rebase(server);
+    mark_ui_dirty(server);
+    mark_content_dirty(server);
+}
+
+// While the overview is up it takes every click: a thumbnail focuses its
+// window, anywhere else just closes the overview.
+bool overview_handle_click(ArolloaServer *server, const struct wlr_pointer_button_event *event) {
+    if (!server->overview.visible) {
+        return false;
+    }
+    if (event->state != WLR_BUTTON_PRESSED) {
+        return true;
+    }
+
+    ArolloaView *target = nullptr;
+    if (ArolloaOutput *output = output_at_cursor(server)) {
+        // Laid out afresh: the cells from the last frame may belong to
+        // another output or to views that have since gone away.
+        std::vector<OverviewState::Cell> cells;
+        overview_layout(server, output, cells);
+        struct wlr_box output_box = {};
+        wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+        const double local_x = server->cursor_x - output_box.x;
+        const double local_y = server->cursor_y - output_box.y;
+        for (const auto &cell : cells) {
+            if (wlr_box_contains_point(&cell.box, local_x, local_y)) {
+                target = cell.view;
+                break;
+            }
+        }
+    }
+
+    close_overview(server);
+    if (target) {
+        focus_view(server, target);
+    }
+    return true;
+}
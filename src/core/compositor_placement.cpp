@@ -0,0 +1,144 @@
+#include "../../include/arolloa.h"
+
+namespace {
+constexpr int GAP = SwissDesign::WINDOW_GAP;
+constexpr int CASCADE_STEP = SwissDesign::GRID_UNIT * 4;
+constexpr uint32_t CASCADE_POSITIONS = 8;
+
+bool box_contains(const struct wlr_box &outer, const struct wlr_box &inner) {
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+           inner.y + inner.height <= outer.y + outer.height;
+}
+
+// Maximal free rectangles: every free rectangle the obstacle overlaps is
+// replaced by the up to four strips around the overlap, then rectangles
+// contained in another one are dropped.
+void subtract_obstacle(std::vector<struct wlr_box> &free, const struct wlr_box &obstacle,
+                       std::vector<struct wlr_box> &next) {
+    next.clear();
+    for (const auto &rect : free) {
+        struct wlr_box overlap = {};
+        if (!wlr_box_intersection(&overlap, &rect, &obstacle)) {
+            next.push_back(rect);
+            continue;
+        }
+        const int rect_right = rect.x + rect.width;
+        const int rect_bottom = rect.y + rect.height;
+        const int overlap_right = overlap.x + overlap.width;
+        const int overlap_bottom = overlap.y + overlap.height;
+        if (overlap.x > rect.x) {
+            next.push_back({.x = rect.x, .y = rect.y, .width = overlap.x - rect.x, .height = rect.height});
+        }
+        if (overlap_right < rect_right) {
+            next.push_back({.x = overlap_right, .y = rect.y, .width = rect_right - overlap_right,
+                            .height = rect.height});
+        }
+        if (overlap.y > rect.y) {
+            next.push_back({.x = rect.x, .y = rect.y, .width = rect.width, .height = overlap.y - rect.y});
+        }
+        if (overlap_bottom < rect_bottom) {
+            next.push_back({.x = rect.x, .y = overlap_bottom, .width = rect.width,
+                            .height = rect_bottom - overlap_bottom});
+        }
+    }
+
+    free.clear();
+    for (std::size_t i = 0; i < next.size(); ++i) {
+        bool redundant = false;
+        for (std::size_t j = 0; j < next.size() && !redundant; ++j) {
+            // Of two identical rectangles only the first survives.
+            redundant = i != j && box_contains(next[j], next[i]) && (!box_contains(next[i], next[j]) || j < i);
+        }
+        if (!redundant) {
+            free.push_back(next[i]);
+        }
+    }
+}
+} // namespace
+
+// The output the cursor is on, or the first output when it is on none.
+ArolloaOutput *output_at_cursor(ArolloaServer *server) {
+    if (!server || wl_list_empty(&server->outputs)) {
+        return nullptr;
+    }
+
+    struct wlr_output *under = wlr_output_layout_output_at(server->output_layout, server->cursor_x, server->cursor_y);
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        if (output->wlr_output == under) {
+            return output;
+        }
+    }
+    return wl_container_of(server->outputs.next, output, link);
+}
+
+// Layout-space area of an output left for windows below the panel.
+struct wlr_box output_usable_area(ArolloaServer *server, ArolloaOutput *output) {
+    struct wlr_box box = {};
+    wlr_output_layout_get_box(server->output_layout, output->wlr_output, &box);
+    if (wlr_box_empty(&box)) {
+        return {};
+    }
+    return {
+        .x = box.x + GAP,
+        .y = box.y + SwissDesign::PANEL_HEIGHT + GAP,
+        .width = std::max(box.width - 2 * GAP, 0),
+        .height = std::max(box.height - SwissDesign::PANEL_HEIGHT - 2 * GAP, 0),
+    };
+}
+
+// Puts a floating view in the top-most, then left-most, free spot on the
+// output under the cursor that fits its frame. When the output is full the
+// view cascades from the top-left corner instead, always fully on screen.
+void place_view(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    ArolloaOutput *output = output_at_cursor(server);
+    const struct wlr_box area = output ? output_usable_area(server, output) : wlr_box{};
+    if (wlr_box_empty(&area)) {
+        view->x = GAP;
+        view->y = SwissDesign::PANEL_HEIGHT + GAP;
+        return;
+    }
+
+    view->x = 0;
+    view->y = 0;
+    struct wlr_box frame = view_frame_box(view);
+    const int offset_x = -frame.x;
+    const int offset_y = -frame.y;
+
+    std::vector<struct wlr_box> free = {area};
+    std::vector<struct wlr_box> scratch;
+    ArolloaView *other = nullptr;
+    wl_list_for_each(other, &server->views, link) {
+        if (other == view || !other->mapped || other->awaiting_layout || other->hidden) {
+            continue;
+        }
+        struct wlr_box obstacle = view_frame_box(other);
+        obstacle.x -= GAP;
+        obstacle.y -= GAP;
+        obstacle.width += 2 * GAP;
+        obstacle.height += 2 * GAP;
+        subtract_obstacle(free, obstacle, scratch);
+    }
+
+    const struct wlr_box *best = nullptr;
+    for (const auto &rect : free) {
+        if (rect.width < frame.width || rect.height < frame.height) {
+            continue;
+        }
+        if (!best || rect.y < best->y || (rect.y == best->y && rect.x < best->x)) {
+            best = &rect;
+        }
+    }
+
+    if (best) {
+        frame.x = best->x;
+        frame.y = best->y;
+    } else {
+        const int step = static_cast<int>(server->placement.cascade++ % CASCADE_POSITIONS) * CASCADE_STEP;
+        frame.x = std::max(area.x, std::min(area.x + step, area.x + area.width - frame.width));
+        frame.y = std::max(area.y, std::min(area.y + step, area.y + area.height - frame.height));
+    }
+    view->x = frame.x + offset_x;
+    view->y = frame.y + offset_y;
+}
@@ -0,0 +1,147 @@
+#include "../../include/arolloa.h"
+
+#include <cstdlib>
+#include <filesystem>
+
+namespace {
+constexpr int POWER_POLL_INTERVAL_MS = 30000;
+constexpr int MIN_UI_FRAME_RATE = 5;
+constexpr int MAX_UI_FRAME_RATE = 60;
+
+std::string read_first_line(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+bool running_on_battery() {
+    std::error_code error;
+    std::filesystem::directory_iterator it("/sys/class/power_supply", error);
+    if (error) {
+        return false;
+    }
+
+    for (const auto &entry : it) {
+        if (read_first_line(entry.path() / "type") != "Battery") {
+            continue;
+        }
+        if (read_first_line(entry.path() / "status") == "Discharging") {
+            return true;
+        }
+    }
+    return false;
+}
+
+// SSH sessions are detected. VNC and RDP servers attach like any local
+// client, and the headless backend is just as often CI or a test harness,
+// so those sessions have to be marked remote in the config.
+bool running_remotely() {
+    if (getenv("SSH_CONNECTION") || getenv("SSH_CLIENT") || getenv("SSH_TTY")) {
+        return true;
+    }
+    return get_config_bool("power.remote_session", false);
+}
+
+void apply_low_power(ArolloaServer *server, bool enabled) {
+    if (server->motion.low_power == enabled) {
+        return;
+    }
+
+    server->motion.low_power = enabled;
+    wlr_log(WLR_INFO, "Low-power UI pacing %s (%d fps cap)", enabled ? "enabled" : "disabled",
+            server->motion.ui_frame_rate);
+
+    // Leaving low-power mode resumes continuous frames; entering it lets the
+    // next idle frame stop the output until something changes.
+    mark_ui_dirty(server);
+}
+
+int handle_power_poll(void *data) {
+    auto *server = static_cast<ArolloaServer *>(data);
+    if (server->motion.low_power_auto) {
+        apply_low_power(server, running_on_battery() || running_remotely());
+    }
+    wl_event_source_timer_update(server->motion.power_poll_timer, POWER_POLL_INTERVAL_MS);
+    return 0;
+}
+
+int handle_ui_tick(void *data) {
+    auto *server = static_cast<ArolloaServer *>(data);
+    schedule_output_frames(server);
+    return 0;
+}
+} // namespace
+
+void motion_policy_init(ArolloaServer *server) {
+    if (!server || !server->wl_display) {
+        return;
+    }
+
+    auto &motion = server->motion;
+    motion.reduced_motion = !get_config_bool("animation.enabled", true);
+    motion.ui_frame_rate = std::clamp(get_config_int("animation.low_power_fps", 20), MIN_UI_FRAME_RATE, MAX_UI_FRAME_RATE);
+
+    const std::string mode = get_config_string("power.low_power", "auto");
+    motion.low_power_auto = mode == "auto";
+    motion.low_power = mode == "on" || (motion.low_power_auto && (running_on_battery() || running_remotely()));
+
+    struct wl_event_loop *loop = wl_display_get_event_loop(server->wl_display);
+    motion.ui_tick_timer = wl_event_loop_add_timer(loop, handle_ui_tick, server);
+    if (motion.low_power_auto) {
+        motion.power_poll_timer = wl_event_loop_add_timer(loop, handle_power_poll, server);
+        if (motion.power_poll_timer) {
+            wl_event_source_timer_update(motion.power_poll_timer, POWER_POLL_INTERVAL_MS);
+        }
+    }
+
+    wlr_log(WLR_INFO, "UI motion: %s, low-power %s%s", motion.reduced_motion ? "instant" : "animated",
+            motion.low_power ? "on" : "off", motion.low_power_auto ? " (auto)" : "");
+}
+
+void motion_policy_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    if (server->motion.ui_tick_timer) {
+        wl_event_source_remove(server->motion.ui_tick_timer);
+        server->motion.ui_tick_timer = nullptr;
+    }
+    if (server->motion.power_poll_timer) {
+        wl_event_source_remove(server->motion.power_poll_timer);
+        server->motion.power_poll_timer = nullptr;
+    }
+}
+
+void set_low_power_mode(ArolloaServer *server, bool enabled) {
+    if (!server) {
+        return;
+    }
+
+    // An explicit choice overrides battery detection until the next restart.
+    server->motion.low_power_auto = false;
+    apply_low_power(server, enabled);
+}
+
+void toggle_low_power_mode(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    set_low_power_mode(server, !server->motion.low_power);
+    show_system_notification(server, "Low power mode", server->motion.low_power ? "UI animation capped" : "Full frame rate");
+}
+
+// Called from an idle low-power frame: wake the outputs again when the next
+// capped UI tick is due, if anything is still animating.
+void schedule_ui_tick(ArolloaServer *server) {
+    if (!server || !server->motion.ui_tick_timer || !ui_animation_pending(server)) {
+        return;
+    }
+
+    const auto interval = std::chrono::duration<float>(1.0f / std::max(server->motion.ui_frame_rate, 1));
+    const auto elapsed = std::chrono::steady_clock::now() - server->motion.last_ui_tick;
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(interval - elapsed).count();
+    wl_event_source_timer_update(server->motion.ui_tick_timer, static_cast<int>(std::max<long long>(remaining, 1)));
+}
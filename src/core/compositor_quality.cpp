@@ -0,0 +1,116 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+
+namespace {
+// Frame load is tracked as an exponential moving average of the time spent in
+// output_frame divided by the output refresh interval.
+constexpr float LOAD_SMOOTHING = 0.12f;
+constexpr float OVERRUN_LOAD = 0.85f;
+constexpr float HEADROOM_LOAD = 0.45f;
+
+// Hysteresis: stepping down reacts within a third of a second at 60 Hz, while
+// stepping back up waits for several seconds of sustained headroom.
+constexpr int STEP_DOWN_FRAMES = 20;
+constexpr int STEP_UP_FRAMES = 240;
+
+constexpr float FALLBACK_REFRESH_MHZ = 60000.0f;
+
+float refresh_interval_ms(const ArolloaOutput *output) {
+    float refresh = FALLBACK_REFRESH_MHZ;
+    if (output && output->wlr_output && output->wlr_output->refresh > 0) {
+        refresh = static_cast<float>(output->wlr_output->refresh);
+    }
+    return 1000000.0f / refresh;
+}
+
+void set_quality_level(ArolloaServer *server, RenderQuality level) {
+    if (server->quality.level == level) {
+        return;
+    }
+
+    wlr_log(WLR_INFO, "Render quality %s -> %s (load %.2f, last frame %.2f ms)",
+            render_quality_name(server->quality.level), render_quality_name(level),
+            server->quality.load, server->quality.last_frame_ms);
+    server->quality.level = level;
+    server->quality.frames_since_change = 0;
+    mark_ui_dirty(server);
+}
+} // namespace
+
+void quality_governor_init(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    server->quality = QualityGovernor{};
+    server->quality.enabled = get_config_bool("performance.adaptive_quality", true);
+}
+
+void quality_governor_record_frame(ArolloaServer *server, const ArolloaOutput *output, float frame_ms) {
+    if (!server || frame_ms < 0.0f) {
+        return;
+    }
+
+    auto &governor = server->quality;
+    governor.last_frame_ms = frame_ms;
+    if (!governor.enabled) {
+        return;
+    }
+
+    const float load = frame_ms / refresh_interval_ms(output);
+    governor.load += (load - governor.load) * LOAD_SMOOTHING;
+    ++governor.frames_since_change;
+
+    const int level = static_cast<int>(governor.level);
+    if (governor.load > OVERRUN_LOAD && governor.frames_since_change >= STEP_DOWN_FRAMES &&
+        governor.level != RenderQuality::MINIMAL) {
+        set_quality_level(server, static_cast<RenderQuality>(level + 1));
+    } else if (governor.load < HEADROOM_LOAD && governor.frames_since_change >= STEP_UP_FRAMES &&
+               governor.level != RenderQuality::FULL) {
+        set_quality_level(server, static_cast<RenderQuality>(level - 1));
+    }
+}
+
+const char *render_quality_name(RenderQuality quality) {
+    switch (quality) {
+        case RenderQuality::FULL:
+            return "full";
+        case RenderQuality::REDUCED:
+            return "reduced";
+        case RenderQuality::FLAT:
+            return "flat";
+        case RenderQuality::MINIMAL:
+            return "minimal";
+    }
+    return "unknown";
+}
+
+float quality_animation_scale(const ArolloaServer *server) {
+    if (!server) {
+        return 1.0f;
+    }
+
+    switch (server->quality.level) {
+        case RenderQuality::FULL:
+            return 1.0f;
+        case RenderQuality::REDUCED:
+        case RenderQuality::FLAT:
+            return 0.5f;
+        case RenderQuality::MINIMAL:
+            return 0.0f;
+    }
+    return 1.0f;
+}
+
+bool quality_draws_shadows(const ArolloaServer *server) {
+    return server && server->quality.level == RenderQuality::FULL;
+}
+
+bool quality_draws_hover_halos(const ArolloaServer *server) {
+    return server && static_cast<int>(server->quality.level) < static_cast<int>(RenderQuality::FLAT);
+}
+
+bool quality_uses_flat_surfaces(const ArolloaServer *server) {
+    return server && static_cast<int>(server->quality.level) >= static_cast<int>(RenderQuality::FLAT);
+}
@@ -0,0 +1,147 @@
+#include "../../include/arolloa.h"
+
+namespace {
+// Below this many records compaction costs more than the holes it removes.
+constexpr std::size_t MIN_COMPACT_SIZE = 64;
+
+RenderRecord *record_for(ArolloaServer *server, const ArolloaView *view) {
+    if (view->render_slot == 0) {
+        return nullptr;
+    }
+    return &server->render_list.records[view->render_slot - 1];
+}
+
+void fill_record(RenderRecord &record, ArolloaView *view) {
+    struct wlr_surface *surface = view->xdg_surface->surface;
+    record.view = view;
+    record.surface = surface;
+    // A view in a layout transaction keeps showing the buffer it had. The
+    // surface texture dies with its client buffer, so every commit refreshes
+    // the record.
+    record.texture = view->saved_texture ? view->saved_texture : wlr_surface_get_texture(surface);
+    record.box = {.x = view->x, .y = view->y, .width = view->width, .height = view->height};
+    record.opacity = view->opacity;
+    record.flags = 0;
+    if (view->mapped && !view->hidden && !view->awaiting_layout) {
+        record.flags |= RENDER_VISIBLE;
+    }
+    if (view->server_decorated && !view->fullscreen) {
+        record.flags |= RENDER_DECORATED;
+    }
+    record.frame_output = frame_output_for(view->server, record.box);
+}
+
+void append(ArolloaServer *server, ArolloaView *view) {
+    auto &list = server->render_list;
+    list.records.emplace_back();
+    fill_record(list.records.back(), view);
+    view->render_slot = static_cast<uint32_t>(list.records.size());
+    ++list.live;
+}
+
+void vacate(ArolloaServer *server, ArolloaView *view) {
+    auto &list = server->render_list;
+    list.records[view->render_slot - 1] = {};
+    view->render_slot = 0;
+    --list.live;
+}
+
+// Squeezes out holes while keeping the order, then renumbers the views.
+void compact(ArolloaServer *server) {
+    auto &records = server->render_list.records;
+    while (!records.empty() && !records.back().view) {
+        records.pop_back();
+    }
+    if (records.size() < MIN_COMPACT_SIZE || records.size() <= server->render_list.live * 2) {
+        return;
+    }
+
+    std::size_t next = 0;
+    for (auto &record : records) {
+        if (record.view) {
+            records[next] = record;
+            records[next].view->render_slot = static_cast<uint32_t>(next + 1);
+            ++next;
+        }
+    }
+    records.resize(next);
+}
+} // namespace
+
+// The output showing the largest part of the box. A view spanning two
+// monitors is paced by that one rather than by both, and belongs to it
+// once it stops moving.
+ArolloaOutput *frame_output_for(ArolloaServer *server, const struct wlr_box &box) {
+    ArolloaOutput *best = nullptr;
+    long best_area = 0;
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        struct wlr_box output_box = {};
+        wlr_output_layout_get_box(server->output_layout, output->wlr_output, &output_box);
+        struct wlr_box overlap = {};
+        if (!wlr_box_intersection(&overlap, &box, &output_box)) {
+            continue;
+        }
+        const long area = static_cast<long>(overlap.width) * overlap.height;
+        if (area > best_area) {
+            best = output;
+            best_area = area;
+        }
+    }
+    return best;
+}
+
+// Refreshes the view's record after its geometry, buffer, opacity or
+// visibility changed. Views without one are added on top.
+void render_list_update(ArolloaView *view) {
+    if (!view || !view->mapped) {
+        return;
+    }
+
+    ArolloaServer *server = view->server;
+    if (RenderRecord *record = record_for(server, view)) {
+        fill_record(*record, view);
+    } else {
+        append(server, view);
+    }
+}
+
+// Moves the view's record to the top in constant time; the old slot stays
+// behind as a hole until the next compaction.
+void render_list_raise(ArolloaView *view) {
+    if (!view || view->render_slot == 0) {
+        return;
+    }
+
+    ArolloaServer *server = view->server;
+    if (view->render_slot == server->render_list.records.size()) {
+        return;
+    }
+    vacate(server, view);
+    append(server, view);
+    compact(server);
+}
+
+// Outputs moved, appeared or went away: every view may be shown by a
+// different output now.
+void render_list_outputs_changed(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    for (auto &record : server->render_list.records) {
+        if (record.view) {
+            fill_record(record, record.view);
+        }
+    }
+}
+
+void render_list_remove(ArolloaView *view) {
+    if (!view || view->render_slot == 0) {
+        return;
+    }
+
+    ArolloaServer *server = view->server;
+    vacate(server, view);
+    compact(server);
+}
@@ -263,6 +263,7 @@ void server_init(ArolloaServer *server) {
 
     wl_list_init(&server->outputs);
     wl_list_init(&server->views);
+    wl_list_init(&server->focus_order);
     wl_list_init(&server->keyboards);
 
     server->layout_mode = WindowLayout::GRID;
@@ -271,7 +272,11 @@ void server_init(ArolloaServer *server) {
     wl_signal_add(&server->backend->events.new_output, &server->new_output);
 
     server->new_xdg_surface.notify = server_new_xdg_surface;
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    wl_signal_add(&server->xdg_shell->events.new_toplevel, &server->new_xdg_surface);
+#else
     wl_signal_add(&server->xdg_shell->events.new_surface, &server->new_xdg_surface);
+#endif
 
     server->new_input.notify = server_new_input;
     wl_signal_add(&server->backend->events.new_input, &server->new_input);
@@ -458,6 +463,15 @@ void server_init(ArolloaServer *server) {
             server->debug_mode ? " (debug nested mode)" : "");
 
     initialize_forest_ui(server);
+    quality_governor_init(server);
+    motion_policy_init(server);
+    keybindings_init(server);
+    process_launcher_init(server);
+    activation_init(server);
+    decoration_init(server);
+    thumbnail_cache_init(server);
+    app_catalog_init(server);
+    latency_trace_init(server);
     schedule_startup_animation(server);
     server->initialized = true;
 }
@@ -68,6 +68,19 @@ void server_destroy(ArolloaServer *server) {
     }
 
     teardown_pointer_interactions(server);
+    motion_policy_finish(server);
+    keybindings_finish(server);
+    activation_finish(server);
+    decoration_finish(server);
+    switcher_finish(server);
+    thumbnail_cache_finish(server);
+    process_launcher_finish(server);
+    tiling_finish(server);
+    transaction_finish(server);
+    app_catalog_finish(server);
+    launcher_row_cache_clear(server);
+    latency_trace_finish(server);
+    keymap_cache_finish(server);
 
     if (server->cursor_mgr) {
         wlr_xcursor_manager_destroy(server->cursor_mgr);
@@ -146,6 +159,7 @@ void server_destroy(ArolloaServer *server) {
     server->ui_state.panel_apps.clear();
     server->ui_state.tray_icons.clear();
     server->ui_state.launcher_entries.clear();
+    server->ui_state.launcher_matches.clear();
     server->animations.clear();
     server->initialized = false;
 }
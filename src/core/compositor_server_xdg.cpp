@@ -1,8 +1,20 @@
 #include "../../include/arolloa.h"
+#include <wlr/version.h>
 
 #include <memory>
 
 namespace {
+// Drops any grab on the view, including a resize still waiting for its last
+// configure to land.
+void release_grab(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    if (server->grab.view != view) {
+        return;
+    }
+    grab_end(server);
+    server->grab = {};
+}
+
 void xdg_surface_map(struct wl_listener *listener, void *data) {
     (void)data;
     ArolloaView *view = wl_container_of(listener, view, map);
@@ -10,23 +22,119 @@ void xdg_surface_map(struct wl_listener *listener, void *data) {
     view->opacity = 0.0f;
 
     auto animation = std::make_unique<Animation>();
-    animation->start(0.0f, 1.0f, SwissDesign::ANIMATION_DURATION, [view](float value) {
+    const float duration = SwissDesign::ANIMATION_DURATION * ui_animation_scale(view->server);
+    animation->start(0.0f, 1.0f, duration, [view](float value) {
         view->opacity = value;
+        render_list_update(view);
+        mark_region_dirty(view->server, view_frame_box(view));
     });
     push_animation(view->server, std::move(animation));
 
-    static int window_count = 0;
-    view->x = (window_count % 2) * 640;
-    view->y = (window_count / 2) * 480 + SwissDesign::PANEL_HEIGHT;
-    window_count++;
+    view->width = view->xdg_surface->surface->current.width;
+    view->height = view->xdg_surface->surface->current.height;
+    decoration_sync(view);
+
+    // Tiling places the view on its next flush; floating views go to free
+    // space on the output under the cursor.
+    if (!tiling_view_mapped(view)) {
+        place_view(view);
+    }
+    workspace_view_mapped(view);
+    if (view->xdg_surface->toplevel->requested.fullscreen) {
+        view_set_fullscreen(view, true, view->xdg_surface->toplevel->requested.fullscreen_output);
+    }
+
+    activation_view_mapped(view);
+
+    // New windows open on top of the stack with keyboard focus.
+    render_list_update(view);
+    focus_view(view->server, view);
+    view_index_update(view->server, view);
+    cursor_rebase(view->server);
 
     wlr_log(WLR_INFO, "Surface mapped at %d,%d", view->x, view->y);
+    mark_ui_dirty(view->server);
+    mark_content_dirty(view->server);
 }
 
 void xdg_surface_unmap(struct wl_listener *listener, void *data) {
     (void)data;
     ArolloaView *view = wl_container_of(listener, view, unmap);
     view->mapped = false;
+    release_grab(view);
+    fullscreen_view_unmapped(view);
+    tiling_view_unmapped(view);
+    transaction_forget_view(view);
+    view_index_remove(view->server, view);
+    render_list_remove(view);
+    thumbnail_forget_view(view);
+    switcher_forget_view(view);
+    wl_list_remove(&view->focus_link);
+    wl_list_init(&view->focus_link);
+    if (view->server->focused_view == view) {
+        focus_top_view(view->server);
+    }
+    cursor_rebase(view->server);
+    mark_ui_dirty(view->server);
+    mark_content_dirty(view->server);
+}
+
+void xdg_surface_commit(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaView *view = wl_container_of(listener, view, commit);
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    if (view->xdg_surface->initial_commit) {
+        // Let the client pick its own initial size.
+        wlr_xdg_toplevel_set_size(view->xdg_surface->toplevel, 0, 0);
+        decoration_initial_commit(view);
+        return;
+    }
+#endif
+    if (!view->mapped) {
+        return;
+    }
+    ++view->content_seq;
+    decoration_sync(view);
+
+    // Windows in an unfinished layout change keep showing their old state.
+    // One that only moves holds no saved buffer: its record must follow the
+    // new texture, as the old one is freed along with its client buffer.
+    if (transaction_handle_commit(view)) {
+        render_list_update(view);
+        if (!view->saved_texture) {
+            damage_view_commit(view);
+        }
+        latency_trace_surface_commit(view->server, view->xdg_surface->surface);
+        return;
+    }
+
+    // Resizes from the left or top edge move the view as the size lands.
+    const struct wlr_box old_frame = view_frame_box(view);
+    grab_handle_commit(view);
+
+    // Server-side decorations are drawn into the UI overlay and follow the
+    // surface size.
+    const struct wlr_surface *surface = view->xdg_surface->surface;
+    view->width = surface->current.width;
+    view->height = surface->current.height;
+    const struct wlr_box new_frame = view_frame_box(view);
+    if (!wlr_box_equal(&old_frame, &new_frame)) {
+        view_index_update(view->server, view);
+        mark_region_dirty(view->server, old_frame);
+        mark_region_dirty(view->server, new_frame);
+    }
+    render_list_update(view);
+
+    damage_view_commit(view);
+    latency_trace_surface_commit(view->server, view->xdg_surface->surface);
+}
+
+void xdg_toplevel_set_title(struct wl_listener *listener, void *data) {
+    (void)data;
+    ArolloaView *view = wl_container_of(listener, view, set_title);
+    if (view->mapped) {
+        mark_ui_dirty(view->server);
+    }
 }
 
 void xdg_surface_destroy(struct wl_listener *listener, void *data) {
@@ -35,28 +143,135 @@ void xdg_surface_destroy(struct wl_listener *listener, void *data) {
     wl_list_remove(&view->map.link);
     wl_list_remove(&view->unmap.link);
     wl_list_remove(&view->destroy.link);
+    wl_list_remove(&view->commit.link);
+    if (view->xdg_surface->toplevel) {
+        wl_list_remove(&view->request_move.link);
+        wl_list_remove(&view->request_resize.link);
+        wl_list_remove(&view->set_title.link);
+        wl_list_remove(&view->request_fullscreen.link);
+    }
     wl_list_remove(&view->link);
+    release_grab(view);
+    fullscreen_view_unmapped(view);
+    tiling_view_unmapped(view);
+    transaction_forget_view(view);
+    view_index_remove(view->server, view);
+    render_list_remove(view);
+    thumbnail_forget_view(view);
+    switcher_forget_view(view);
+    wl_list_remove(&view->focus_link);
+    if (view->server->focused_view == view) {
+        view->server->focused_view = nullptr;
+    }
+    view->xdg_surface->data = nullptr;
     free(view);
 }
 
+// Clients may only start a grab in response to a button press we sent them.
+bool grab_request_valid(ArolloaView *view, uint32_t serial) {
+    return view->mapped && !view->fullscreen && view->server->grab.mode == GrabMode::NONE &&
+           wlr_seat_validate_pointer_grab_serial(view->server->seat, view->xdg_surface->surface, serial);
+}
+
 void xdg_toplevel_request_move(struct wl_listener *listener, void *data) {
-    (void)listener;
-    (void)data;
+    ArolloaView *view = wl_container_of(listener, view, request_move);
+    const auto *event = static_cast<const struct wlr_xdg_toplevel_move_event *>(data);
+    if (!grab_request_valid(view, event->serial)) {
+        return;
+    }
+    begin_interactive(view, GrabMode::MOVE, WLR_EDGE_NONE);
 }
 
 void xdg_toplevel_request_resize(struct wl_listener *listener, void *data) {
-    (void)listener;
+    ArolloaView *view = wl_container_of(listener, view, request_resize);
+    const auto *event = static_cast<const struct wlr_xdg_toplevel_resize_event *>(data);
+    if (!grab_request_valid(view, event->serial)) {
+        return;
+    }
+    begin_interactive(view, GrabMode::RESIZE, event->edges);
+}
+
+// Unmapped views pick their requested state up when they map. xdg-shell
+// wants a configure in reply either way, which wlroots 0.18 only allows
+// after the initial commit.
+void xdg_toplevel_request_fullscreen(struct wl_listener *listener, void *data) {
     (void)data;
+    ArolloaView *view = wl_container_of(listener, view, request_fullscreen);
+    struct wlr_xdg_toplevel *toplevel = view->xdg_surface->toplevel;
+    if (view->mapped) {
+        view_set_fullscreen(view, toplevel->requested.fullscreen, toplevel->requested.fullscreen_output);
+        return;
+    }
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    if (!view->xdg_surface->initialized) {
+        return;
+    }
+#endif
+    wlr_xdg_surface_schedule_configure(view->xdg_surface);
 }
 } // namespace
 
+// Hands keyboard focus to the most recently focused visible view, if any.
+// The caller has already dealt with the previously focused view.
+void focus_top_view(ArolloaServer *server) {
+    server->focused_view = nullptr;
+    ArolloaView *view = nullptr;
+    wl_list_for_each(view, &server->focus_order, focus_link) {
+        if (!view->hidden) {
+            focus_view(server, view);
+            return;
+        }
+    }
+    wlr_seat_keyboard_clear_focus(server->seat);
+}
+
+// Raises the view and moves keyboard focus to it. Only the two frames whose
+// active state changed are repainted. Views on an inactive workspace are
+// left alone; callers that mean to show one switch workspace first.
+void focus_view(ArolloaServer *server, ArolloaView *view) {
+    if (!server || !view || !view->mapped || view->hidden || !view->xdg_surface->toplevel) {
+        return;
+    }
+
+    raise_view(server, view);
+    if (server->focused_view == view) {
+        return;
+    }
+
+    if (ArolloaView *previous = server->focused_view) {
+        if (previous->xdg_surface->toplevel) {
+            wlr_xdg_toplevel_set_activated(previous->xdg_surface->toplevel, false);
+        }
+        if (previous->mapped && !previous->hidden) {
+            mark_region_dirty(server, view_frame_box(previous));
+        }
+    }
+    server->focused_view = view;
+    wl_list_remove(&view->focus_link);
+    wl_list_insert(&server->focus_order, &view->focus_link);
+    wlr_xdg_toplevel_set_activated(view->xdg_surface->toplevel, true);
+    mark_region_dirty(server, view_frame_box(view));
+
+    if (struct wlr_keyboard *keyboard = wlr_seat_get_keyboard(server->seat)) {
+        wlr_seat_keyboard_notify_enter(server->seat, view->xdg_surface->surface, keyboard->keycodes,
+                                       keyboard->num_keycodes, &keyboard->modifiers);
+    }
+}
+
+// wlroots 0.18 announces xdg_surfaces before they have a role, so toplevels
+// are picked up from the dedicated new_toplevel signal instead.
 void server_new_xdg_surface(struct wl_listener *listener, void *data) {
     ArolloaServer *server = wl_container_of(listener, server, new_xdg_surface);
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    auto *toplevel = static_cast<struct wlr_xdg_toplevel *>(data);
+    struct wlr_xdg_surface *xdg_surface = toplevel->base;
+#else
     auto *xdg_surface = static_cast<struct wlr_xdg_surface *>(data);
 
     if (xdg_surface->role != WLR_XDG_SURFACE_ROLE_TOPLEVEL) {
         return;
     }
+#endif
 
     ArolloaView *view = static_cast<ArolloaView *>(calloc(1, sizeof(ArolloaView)));
     if (!view) {
@@ -66,6 +281,8 @@ void server_new_xdg_surface(struct wl_listener *listener, void *data) {
     view->server = server;
     view->xdg_surface = xdg_surface;
     view->opacity = 1.0f;
+    wl_list_init(&view->focus_link);
+    xdg_surface->data = view;
 
     view->map.notify = xdg_surface_map;
     wl_signal_add(&xdg_surface->surface->events.map, &view->map);
@@ -74,7 +291,14 @@ void server_new_xdg_surface(struct wl_listener *listener, void *data) {
     wl_signal_add(&xdg_surface->surface->events.unmap, &view->unmap);
 
     view->destroy.notify = xdg_surface_destroy;
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    wl_signal_add(&toplevel->events.destroy, &view->destroy);
+#else
     wl_signal_add(&xdg_surface->events.destroy, &view->destroy);
+#endif
+
+    view->commit.notify = xdg_surface_commit;
+    wl_signal_add(&xdg_surface->surface->events.commit, &view->commit);
 
     if (xdg_surface->toplevel) {
         view->request_move.notify = xdg_toplevel_request_move;
@@ -82,7 +306,14 @@ void server_new_xdg_surface(struct wl_listener *listener, void *data) {
 
         view->request_resize.notify = xdg_toplevel_request_resize;
         wl_signal_add(&xdg_surface->toplevel->events.request_resize, &view->request_resize);
+
+        view->set_title.notify = xdg_toplevel_set_title;
+        wl_signal_add(&xdg_surface->toplevel->events.set_title, &view->set_title);
+
+        view->request_fullscreen.notify = xdg_toplevel_request_fullscreen;
+        wl_signal_add(&xdg_surface->toplevel->events.request_fullscreen, &view->request_fullscreen);
     }
 
-    wl_list_insert(&server->views, &view->link);
+    // Keep the views list in stacking order, bottom to top.
+    wl_list_insert(server->views.prev, &view->link);
 }
@@ -0,0 +1,260 @@
+#include "../../include/arolloa.h"
+
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace {
+// Variables that describe the compositor process itself rather than the
+// session; children must not inherit them.
+constexpr const char *PRIVATE_VARIABLES[] = {
+    "WAYLAND_SOCKET", // One-shot fd handed to us by a parent compositor
+    "LISTEN_FDS",
+    "LISTEN_PID",
+    "LISTEN_FDNAMES",
+    "NOTIFY_SOCKET",
+    "DESKTOP_STARTUP_ID",
+    "XDG_ACTIVATION_TOKEN",
+};
+
+bool is_private_variable(const char *entry) {
+    const char *equals = std::strchr(entry, '=');
+    const std::size_t length = equals ? static_cast<std::size_t>(equals - entry) : std::strlen(entry);
+    for (const char *name : PRIVATE_VARIABLES) {
+        if (std::strlen(name) == length && std::strncmp(entry, name, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Anything beyond plain words and quoting needs a real shell.
+bool needs_shell(const std::string &command) {
+    return command.find_first_of("|&;<>()$`*?[]{}~!#\n") != std::string::npos ||
+           command.find('=') < command.find(' ');
+}
+
+// Splits a command into argv words, honouring single and double quotes and
+// backslash escapes the way /bin/sh would for commands without expansions.
+bool tokenize(const std::string &command, std::vector<std::string> &words) {
+    std::string word;
+    bool in_word = false;
+    char quote = '\0';
+    for (std::size_t i = 0; i < command.size(); ++i) {
+        const char c = command[i];
+        if (quote == '\'') {
+            if (c == '\'') {
+                quote = '\0';
+            } else {
+                word.push_back(c);
+            }
+            continue;
+        }
+        if (c == '\\' && i + 1 < command.size()) {
+            const char next = command[++i];
+            if (quote == '"' && next != '"' && next != '\\') {
+                word.push_back(c);
+            }
+            word.push_back(next);
+            in_word = true;
+            continue;
+        }
+        if (quote == '"') {
+            if (c == '"') {
+                quote = '\0';
+            } else {
+                word.push_back(c);
+            }
+            continue;
+        }
+        if (c == '\'' || c == '"') {
+            quote = c;
+            in_word = true;
+        } else if (c == ' ' || c == '\t') {
+            if (in_word) {
+                words.push_back(std::move(word));
+                word.clear();
+                in_word = false;
+            }
+        } else {
+            word.push_back(c);
+            in_word = true;
+        }
+    }
+    if (quote != '\0') {
+        return false;
+    }
+    if (in_word) {
+        words.push_back(std::move(word));
+    }
+    return !words.empty();
+}
+
+// posix_spawn does not close inherited descriptors, so everything above
+// stdio is flagged close-on-exec before each launch. Sockets, DRM and
+// input fds opened by libraries without O_CLOEXEC would otherwise leak.
+void mark_descriptors_cloexec() {
+#if defined(SYS_close_range) && defined(CLOSE_RANGE_CLOEXEC)
+    if (syscall(SYS_close_range, 3u, ~0u, CLOSE_RANGE_CLOEXEC) == 0) {
+        return;
+    }
+#endif
+    DIR *directory = opendir("/proc/self/fd");
+    if (!directory) {
+        return;
+    }
+    const int own_fd = dirfd(directory);
+    while (struct dirent *entry = readdir(directory)) {
+        const int fd = std::atoi(entry->d_name);
+        if (fd < 3 || fd == own_fd) {
+            continue;
+        }
+        const int flags = fcntl(fd, F_GETFD);
+        if (flags >= 0 && !(flags & FD_CLOEXEC)) {
+            fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+        }
+    }
+    closedir(directory);
+}
+
+int handle_sigchld(int signal_number, void *data) {
+    (void)signal_number;
+    auto *server = static_cast<ArolloaServer *>(data);
+    auto &children = server->launcher.children;
+
+    // Signals coalesce, so reap everything that has exited.
+    int status = 0;
+    pid_t pid = 0;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        auto it = children.find(pid);
+        if (it == children.end()) {
+            continue;
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+            wlr_log(WLR_INFO, "'%s' exited with status %d", it->second.c_str(), WEXITSTATUS(status));
+        } else if (WIFSIGNALED(status)) {
+            wlr_log(WLR_INFO, "'%s' killed by signal %d", it->second.c_str(), WTERMSIG(status));
+        }
+        children.erase(it);
+    }
+    return 0;
+}
+} // namespace
+
+void process_launcher_init(ArolloaServer *server) {
+    if (!server || !server->wl_display) {
+        return;
+    }
+
+    auto &launcher = server->launcher;
+    launcher.environment.clear();
+    for (char **entry = environ; entry && *entry; ++entry) {
+        if (!is_private_variable(*entry)) {
+            launcher.environment.emplace_back(*entry);
+        }
+    }
+
+    launcher.sigchld = wl_event_loop_add_signal(wl_display_get_event_loop(server->wl_display), SIGCHLD,
+                                                handle_sigchld, server);
+    if (!launcher.sigchld) {
+        wlr_log(WLR_ERROR, "Failed to watch SIGCHLD; launched programs will not be reaped");
+    }
+}
+
+void process_launcher_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &launcher = server->launcher;
+    if (launcher.sigchld) {
+        wl_event_source_remove(launcher.sigchld);
+        launcher.sigchld = nullptr;
+    }
+    launcher.children.clear();
+}
+
+// Starts a command without blocking the event loop. Simple commands are
+// exec'd directly; anything using shell syntax goes through /bin/sh -c.
+// A non-empty activation token is exported the way xdg-activation and
+// startup-notification clients expect. Returns the child pid, or -1 if
+// nothing was started.
+pid_t spawn_command(ArolloaServer *server, const std::string &command, const std::string &activation_token) {
+    if (!server || command.empty()) {
+        return -1;
+    }
+
+    // Launcher entries historically carried a trailing '&' for std::system.
+    std::string trimmed = command;
+    while (!trimmed.empty() && (trimmed.back() == '&' || trimmed.back() == ' ')) {
+        trimmed.pop_back();
+    }
+
+    std::vector<std::string> words;
+    if (needs_shell(trimmed) || !tokenize(trimmed, words)) {
+        words = {"/bin/sh", "-c", trimmed};
+    }
+
+    std::vector<char *> argv;
+    argv.reserve(words.size() + 1);
+    for (auto &word : words) {
+        argv.push_back(word.data());
+    }
+    argv.push_back(nullptr);
+
+    std::string token_variables[] = {
+        "XDG_ACTIVATION_TOKEN=" + activation_token,
+        "DESKTOP_STARTUP_ID=" + activation_token,
+    };
+    std::vector<char *> envp;
+    envp.reserve(server->launcher.environment.size() + 3);
+    for (auto &entry : server->launcher.environment) {
+        envp.push_back(entry.data());
+    }
+    if (!activation_token.empty()) {
+        for (auto &variable : token_variables) {
+            envp.push_back(variable.data());
+        }
+    }
+    envp.push_back(nullptr);
+
+    // The event loop blocks SIGCHLD for its signalfd; children start with
+    // an empty mask and default dispositions instead of inheriting ours.
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGCHLD);
+    sigaddset(&signals, SIGPIPE);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_SETSID
+    // Detach from the compositor's session so terminal signals do not reach it.
+    flags |= POSIX_SPAWN_SETSID;
+#endif
+    posix_spawnattr_setflags(&attributes, flags);
+
+    mark_descriptors_cloexec();
+
+    pid_t pid = -1;
+    const int error = posix_spawnp(&pid, argv[0], nullptr, &attributes, argv.data(), envp.data());
+    posix_spawnattr_destroy(&attributes);
+    if (error != 0) {
+        wlr_log(WLR_ERROR, "Failed to launch '%s': %s", command.c_str(), std::strerror(error));
+        return -1;
+    }
+
+    server->launcher.children.emplace(pid, trimmed);
+    wlr_log(WLR_DEBUG, "Launched '%s' as pid %d", trimmed.c_str(), static_cast<int>(pid));
+    return pid;
+}
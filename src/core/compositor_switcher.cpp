@@ -0,0 +1,315 @@
+#include "../../include/arolloa.h"
+
+#include <wlr/render/pass.h>
+#include <drm_fourcc.h>
+
+namespace {
+constexpr int SLOT_WIDTH = 200;
+constexpr int SLOT_HEIGHT = 140;
+constexpr int LABEL_HEIGHT = 26;
+constexpr int PADDING = 20;
+constexpr int SLOT_GAP = SwissDesign::GUTTER_WIDTH;
+
+// The panel only changes what is on screen inside its own box. Client
+// content is bumped too so low-power pacing does not skip the frame.
+void damage_panel(ArolloaServer *server) {
+    auto &switcher = server->switcher;
+    if (!switcher.output || wlr_box_empty(&switcher.box)) {
+        return;
+    }
+    ++server->content_generation;
+    if (wlr_damage_ring_add_box(&switcher.output->damage_ring, &switcher.box) && server->initialized) {
+        wlr_output_schedule_frame(switcher.output->wlr_output);
+    }
+}
+
+// A centred block of slots, wrapping onto more rows when the views do not
+// fit in four fifths of the output width.
+void layout(ArolloaServer *server) {
+    auto &switcher = server->switcher;
+    damage_panel(server);
+
+    int width = 0;
+    int height = 0;
+    wlr_output_effective_resolution(switcher.output->wlr_output, &width, &height);
+    const int count = static_cast<int>(switcher.views.size());
+    const int max_columns = std::max(1, (width * 4 / 5 - 2 * PADDING + SLOT_GAP) / (SLOT_WIDTH + SLOT_GAP));
+    const int columns = std::min(count, max_columns);
+    const int rows = (count + columns - 1) / columns;
+    const int pitch_y = SLOT_HEIGHT + LABEL_HEIGHT + SLOT_GAP;
+
+    switcher.box.width = 2 * PADDING + columns * SLOT_WIDTH + (columns - 1) * SLOT_GAP;
+    switcher.box.height = 2 * PADDING + rows * pitch_y - SLOT_GAP;
+    switcher.box.x = std::max(0, (width - switcher.box.width) / 2);
+    switcher.box.y = std::max(0, (height - switcher.box.height) / 2);
+
+    switcher.slots.clear();
+    for (int i = 0; i < count; ++i) {
+        switcher.slots.push_back({
+            .x = PADDING + (i % columns) * (SLOT_WIDTH + SLOT_GAP),
+            .y = PADDING + (i / columns) * pitch_y,
+            .width = SLOT_WIDTH,
+            .height = SLOT_HEIGHT,
+        });
+    }
+    switcher.layer_dirty = true;
+    damage_panel(server);
+}
+
+bool open_switcher(ArolloaServer *server) {
+    auto &switcher = server->switcher;
+    switcher.output = output_at_cursor(server);
+    if (!switcher.output) {
+        return false;
+    }
+
+    switcher.views.clear();
+    ArolloaView *view = nullptr;
+    wl_list_for_each(view, &server->focus_order, focus_link) {
+        if (!view->hidden) {
+            switcher.views.push_back(view);
+        }
+    }
+    if (switcher.views.empty()) {
+        switcher.output = nullptr;
+        return false;
+    }
+
+    switcher.active = true;
+    switcher.selected = 0;
+    layout(server);
+    return true;
+}
+
+void close_switcher(ArolloaServer *server) {
+    auto &switcher = server->switcher;
+    damage_panel(server);
+    switcher.active = false;
+    switcher.output = nullptr;
+    switcher.views.clear();
+    switcher.slots.clear();
+    switcher.thumbnails.clear();
+    switcher.box = {};
+}
+
+void draw_label(cairo_t *cr, ArolloaServer *server, const ArolloaView *view, const struct wlr_box &slot,
+                const SwissDesign::Color &color) {
+    PangoLayout *layout = server->pango_layout;
+    const struct wlr_xdg_toplevel *toplevel = view->xdg_surface->toplevel;
+    pango_layout_set_width(layout, slot.width * PANGO_SCALE);
+    pango_layout_set_text(layout, toplevel && toplevel->title ? toplevel->title : "Untitled", -1);
+    cairo_move_to(cr, slot.x, slot.y + slot.height + 6.0);
+    cairo_set_source_rgba(cr, color.r, color.g, color.b, 1.0);
+    pango_cairo_show_layout(cr, layout);
+}
+
+// Rasterises the panel, the selection frame and the titles into the cached
+// layer texture.
+void draw_layer(ArolloaServer *server) {
+    auto &switcher = server->switcher;
+    cairo_surface_t *surface = switcher.layer_surface;
+    if (!surface || cairo_image_surface_get_width(surface) != switcher.box.width ||
+        cairo_image_surface_get_height(surface) != switcher.box.height) {
+        if (surface) {
+            cairo_surface_destroy(surface);
+        }
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, switcher.box.width, switcher.box.height);
+        switcher.layer_surface = surface;
+    }
+
+    cairo_t *cr = cairo_create(surface);
+    const SwissDesign::Color &panel = server->ui_state.panel_base;
+    cairo_set_source_rgba(cr, panel.r, panel.g, panel.b, 0.96);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+    const SwissDesign::Color &accent = server->ui_state.accent_color;
+    const struct wlr_box &selected = switcher.slots[switcher.selected];
+    cairo_set_source_rgba(cr, accent.r, accent.g, accent.b, 1.0);
+    cairo_set_line_width(cr, 3.0);
+    cairo_rectangle(cr, selected.x - 4.5, selected.y - 4.5, selected.width + 9.0, selected.height + 9.0);
+    cairo_stroke(cr);
+
+    if (server->pango_layout) {
+        PangoFontDescription *desc =
+            pango_font_description_from_string((std::string(SwissDesign::SECONDARY_FONT) + " 10").c_str());
+        pango_layout_set_font_description(server->pango_layout, desc);
+        pango_font_description_free(desc);
+        pango_layout_set_alignment(server->pango_layout, PANGO_ALIGN_CENTER);
+        pango_layout_set_ellipsize(server->pango_layout, PANGO_ELLIPSIZE_END);
+        for (std::size_t i = 0; i < switcher.views.size(); ++i) {
+            const SwissDesign::Color &color = i == switcher.selected ? accent : server->ui_state.panel_text;
+            draw_label(cr, server, switcher.views[i], switcher.slots[i], color);
+        }
+        pango_layout_set_width(server->pango_layout, -1);
+        pango_layout_set_ellipsize(server->pango_layout, PANGO_ELLIPSIZE_NONE);
+        pango_layout_set_alignment(server->pango_layout, PANGO_ALIGN_LEFT);
+    }
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    if (switcher.layer) {
+        wlr_texture_destroy(switcher.layer);
+    }
+    switcher.layer = wlr_texture_from_pixels(server->renderer, DRM_FORMAT_ARGB8888,
+        cairo_image_surface_get_stride(surface), switcher.box.width, switcher.box.height,
+        cairo_image_surface_get_data(surface));
+    switcher.layer_dirty = false;
+}
+
+// The thumbnail scaled to fit the slot, centred, in output coordinates.
+struct wlr_box thumbnail_box(const struct wlr_box &panel, const struct wlr_box &slot,
+                             const struct wlr_texture *texture) {
+    const double scale = std::min(static_cast<double>(slot.width) / texture->width,
+                                  static_cast<double>(slot.height) / texture->height);
+    const int width = std::max(1, static_cast<int>(texture->width * scale));
+    const int height = std::max(1, static_cast<int>(texture->height * scale));
+    return {
+        .x = panel.x + slot.x + (slot.width - width) / 2,
+        .y = panel.y + slot.y + (slot.height - height) / 2,
+        .width = width,
+        .height = height,
+    };
+}
+} // namespace
+
+// Opens the switcher on the first step; Alt+Tab lands on the window used
+// before the current one.
+void switcher_step(ArolloaServer *server, int direction) {
+    if (!server) {
+        return;
+    }
+
+    auto &switcher = server->switcher;
+    if (!switcher.active && !open_switcher(server)) {
+        return;
+    }
+    const std::size_t count = switcher.views.size();
+    const std::size_t step = direction < 0 ? count - 1 : 1;
+    switcher.selected = (switcher.selected + step) % count;
+    switcher.layer_dirty = true;
+    damage_panel(server);
+}
+
+void switcher_commit(ArolloaServer *server) {
+    if (!server || !server->switcher.active) {
+        return;
+    }
+
+    ArolloaView *target = server->switcher.views[server->switcher.selected];
+    close_switcher(server);
+    if (!target->hidden) {
+        focus_view(server, target);
+    }
+}
+
+void switcher_cancel(ArolloaServer *server) {
+    if (server && server->switcher.active) {
+        close_switcher(server);
+    }
+}
+
+void switcher_forget_view(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    auto &switcher = server->switcher;
+    auto it = std::find(switcher.views.begin(), switcher.views.end(), view);
+    if (!switcher.active || it == switcher.views.end()) {
+        return;
+    }
+
+    const auto index = static_cast<std::size_t>(it - switcher.views.begin());
+    switcher.views.erase(it);
+    if (switcher.views.empty()) {
+        close_switcher(server);
+        return;
+    }
+    if (index < switcher.selected || switcher.selected == switcher.views.size()) {
+        switcher.selected = switcher.selected == 0 ? 0 : switcher.selected - 1;
+    }
+    switcher.thumbnails.clear();
+    layout(server);
+}
+
+// The thumbnails are live, so any client commit may change the panel.
+void switcher_damage(ArolloaServer *server) {
+    if (server && server->switcher.active) {
+        damage_panel(server);
+    }
+}
+
+// Dropped without damage: the output is going away.
+void switcher_forget_output(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server || server->switcher.output != output) {
+        return;
+    }
+    server->switcher.output = nullptr;
+    close_switcher(server);
+}
+
+// Redraws the layer if needed and fetches the thumbnails. Runs before the
+// output's render pass is opened.
+void switcher_prepare(ArolloaServer *server, ArolloaOutput *output) {
+    auto &switcher = server->switcher;
+    if (!switcher.active || switcher.output != output) {
+        return;
+    }
+
+    if (switcher.layer_dirty) {
+        draw_layer(server);
+    }
+    switcher.thumbnails.resize(switcher.views.size());
+    bool pending = false;
+    for (std::size_t i = 0; i < switcher.views.size(); ++i) {
+        switcher.thumbnails[i] = thumbnail_get(switcher.views[i]);
+        pending = pending || !switcher.thumbnails[i];
+    }
+    if (pending || server->thumbnails.refreshes_left == 0) {
+        wlr_output_schedule_frame(output->wlr_output);
+    }
+}
+
+void switcher_render(ArolloaServer *server, ArolloaOutput *output, struct wlr_render_pass *render_pass,
+                     const pixman_region32_t *clip) {
+    const auto &switcher = server->switcher;
+    if (!switcher.active || switcher.output != output || !switcher.layer) {
+        return;
+    }
+
+    struct wlr_render_texture_options layer = {};
+    layer.texture = switcher.layer;
+    layer.dst_box = switcher.box;
+    layer.clip = clip;
+    wlr_render_pass_add_texture(render_pass, &layer);
+
+    for (std::size_t i = 0; i < switcher.thumbnails.size(); ++i) {
+        if (!switcher.thumbnails[i]) {
+            continue;
+        }
+        struct wlr_render_texture_options options = {};
+        options.texture = switcher.thumbnails[i];
+        options.dst_box = thumbnail_box(switcher.box, switcher.slots[i], switcher.thumbnails[i]);
+        options.clip = clip;
+        options.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+        wlr_render_pass_add_texture(render_pass, &options);
+    }
+}
+
+void switcher_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &switcher = server->switcher;
+    switcher.active = false;
+    switcher.views.clear();
+    switcher.thumbnails.clear();
+    if (switcher.layer) {
+        wlr_texture_destroy(switcher.layer);
+        switcher.layer = nullptr;
+    }
+    if (switcher.layer_surface) {
+        cairo_surface_destroy(switcher.layer_surface);
+        switcher.layer_surface = nullptr;
+    }
+}
@@ -0,0 +1,177 @@
+#include "../../include/arolloa.h"
+
+#include <wlr/render/pass.h>
+#include <drm_fourcc.h>
+
+namespace {
+// Longer edge of a thumbnail; larger overview cells stretch it.
+constexpr int THUMBNAIL_MAX_SIZE = 320;
+constexpr int DEFAULT_BUDGET_MB = 32;
+// A burst of stale thumbnails is spread over a few frames instead of
+// stalling one; the rest show their previous content until then.
+constexpr uint32_t REFRESHES_PER_FRAME = 8;
+
+ThumbnailCache::Thumbnail *find(ThumbnailCache &cache, const ArolloaView *view) {
+    for (auto &thumbnail : cache.thumbnails) {
+        if (thumbnail.view == view) {
+            return &thumbnail;
+        }
+    }
+    return nullptr;
+}
+
+void release(ThumbnailCache &cache, ThumbnailCache::Thumbnail &thumbnail) {
+    if (thumbnail.texture) {
+        wlr_texture_destroy(thumbnail.texture);
+    }
+    if (thumbnail.buffer) {
+        wlr_buffer_drop(thumbnail.buffer);
+    }
+    cache.bytes -= thumbnail.bytes;
+    thumbnail.texture = nullptr;
+    thumbnail.buffer = nullptr;
+    thumbnail.bytes = 0;
+}
+
+// Drops the least recently used thumbnails that were not handed out in the
+// current frame. The budget is soft: thumbnails in use are kept over it.
+void evict_to_budget(ThumbnailCache &cache) {
+    while (cache.bytes > cache.budget) {
+        auto oldest = cache.thumbnails.end();
+        for (auto it = cache.thumbnails.begin(); it != cache.thumbnails.end(); ++it) {
+            if (it->last_frame != cache.frame &&
+                (oldest == cache.thumbnails.end() || it->last_used < oldest->last_used)) {
+                oldest = it;
+            }
+        }
+        if (oldest == cache.thumbnails.end()) {
+            return;
+        }
+        release(cache, *oldest);
+        cache.thumbnails.erase(oldest);
+    }
+}
+
+// Downscales the view's current texture on the GPU (or with pixman on
+// software seats) into a buffer of its own.
+bool redraw(ArolloaServer *server, ThumbnailCache::Thumbnail &thumbnail, struct wlr_texture *source) {
+    const double scale = std::min(1.0, static_cast<double>(THUMBNAIL_MAX_SIZE) /
+                                           std::max(source->width, source->height));
+    const int width = std::max(1, static_cast<int>(source->width * scale));
+    const int height = std::max(1, static_cast<int>(source->height * scale));
+
+    auto &cache = server->thumbnails;
+    if (!thumbnail.buffer || thumbnail.buffer->width != width || thumbnail.buffer->height != height) {
+        release(cache, thumbnail);
+        const struct wlr_drm_format *format =
+            wlr_drm_format_set_get(wlr_renderer_get_render_formats(server->renderer), DRM_FORMAT_ARGB8888);
+        thumbnail.buffer = format ? wlr_allocator_create_buffer(server->allocator, width, height, format) : nullptr;
+        if (!thumbnail.buffer) {
+            return false;
+        }
+        thumbnail.bytes = static_cast<std::size_t>(width) * height * 4;
+        cache.bytes += thumbnail.bytes;
+    }
+
+    struct wlr_render_pass *pass = wlr_renderer_begin_buffer_pass(server->renderer, thumbnail.buffer, nullptr);
+    if (!pass) {
+        return false;
+    }
+    struct wlr_render_rect_options clear = {};
+    clear.box = {.x = 0, .y = 0, .width = width, .height = height};
+    clear.blend_mode = WLR_RENDER_BLEND_MODE_NONE;
+    wlr_render_pass_add_rect(pass, &clear);
+
+    struct wlr_render_texture_options options = {};
+    options.texture = source;
+    options.dst_box = clear.box;
+    options.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+    wlr_render_pass_add_texture(pass, &options);
+    if (!wlr_render_pass_submit(pass)) {
+        return false;
+    }
+
+    // The texture reads the buffer directly; nothing is copied.
+    if (!thumbnail.texture) {
+        thumbnail.texture = wlr_texture_from_buffer(server->renderer, thumbnail.buffer);
+    }
+    return thumbnail.texture != nullptr;
+}
+} // namespace
+
+void thumbnail_cache_init(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+    const int budget_mb = std::max(1, get_config_int("thumbnails.budget_mb", DEFAULT_BUDGET_MB));
+    server->thumbnails.budget = static_cast<std::size_t>(budget_mb) * 1024 * 1024;
+}
+
+void thumbnail_cache_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &cache = server->thumbnails;
+    for (auto &thumbnail : cache.thumbnails) {
+        release(cache, thumbnail);
+    }
+    cache.thumbnails.clear();
+}
+
+// Called once per output frame, before any render pass is open. Textures
+// handed out in the previous frame have been drawn by now, so this is where
+// the budget is enforced; the ones that frame used are likely to be shown
+// again and are kept, rather than recreated every frame.
+void thumbnail_begin_frame(ArolloaServer *server) {
+    auto &cache = server->thumbnails;
+    evict_to_budget(cache);
+    ++cache.frame;
+    cache.refreshes_left = REFRESHES_PER_FRAME;
+}
+
+// The view's thumbnail, redrawn first if the view committed since it was
+// made and this frame still has room for it. Must not be called while a
+// render pass is open. Returns nullptr if there is nothing to show yet.
+struct wlr_texture *thumbnail_get(ArolloaView *view) {
+    if (!view || view->render_slot == 0) {
+        return nullptr;
+    }
+
+    ArolloaServer *server = view->server;
+    auto &cache = server->thumbnails;
+    struct wlr_texture *source = server->render_list.records[view->render_slot - 1].texture;
+    ThumbnailCache::Thumbnail *thumbnail = find(cache, view);
+    if (!thumbnail) {
+        if (!source || cache.refreshes_left == 0) {
+            return nullptr;
+        }
+        cache.thumbnails.push_back({});
+        thumbnail = &cache.thumbnails.back();
+        thumbnail->view = view;
+        thumbnail->content_seq = view->content_seq - 1;
+    }
+    thumbnail->last_used = ++cache.use_counter;
+    thumbnail->last_frame = cache.frame;
+
+    if (thumbnail->content_seq != view->content_seq && source && cache.refreshes_left > 0) {
+        --cache.refreshes_left;
+        if (redraw(server, *thumbnail, source)) {
+            thumbnail->content_seq = view->content_seq;
+        }
+    }
+    return thumbnail->texture;
+}
+
+void thumbnail_forget_view(ArolloaView *view) {
+    auto &cache = view->server->thumbnails;
+    auto it = std::find_if(cache.thumbnails.begin(), cache.thumbnails.end(),
+        [view](const ThumbnailCache::Thumbnail &thumbnail) {
+            return thumbnail.view == view;
+        });
+    if (it == cache.thumbnails.end()) {
+        return;
+    }
+    release(cache, *it);
+    cache.thumbnails.erase(it);
+}
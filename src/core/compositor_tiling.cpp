@@ -0,0 +1,375 @@
+#include "../../include/arolloa.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace {
+constexpr int GAP = SwissDesign::WINDOW_GAP;
+constexpr uint32_t ALL_EDGES = WLR_EDGE_TOP | WLR_EDGE_BOTTOM | WLR_EDGE_LEFT | WLR_EDGE_RIGHT;
+
+// Splits a length into count spans separated by gap; the last span takes
+// the rounding remainder so the outer edges stay aligned.
+int span_offset(int length, int count, int gap, int index) {
+    const int span = (length - (count - 1) * gap) / count;
+    return index * (span + gap);
+}
+
+int span_length(int length, int count, int gap, int index) {
+    const int span = (length - (count - 1) * gap) / count;
+    return index == count - 1 ? length - index * (span + gap) : span;
+}
+
+// Rows of equal height, as square as possible. A short last row widens its
+// tiles to fill the area.
+void grid_tiles(const struct wlr_box &area, std::size_t count, std::vector<struct wlr_box> &tiles) {
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const int rows = static_cast<int>((count + columns - 1) / columns);
+    std::size_t placed = 0;
+    for (int row = 0; row < rows; ++row) {
+        const int in_row = static_cast<int>(std::min<std::size_t>(columns, count - placed));
+        for (int column = 0; column < in_row; ++column) {
+            tiles.push_back({
+                .x = area.x + span_offset(area.width, in_row, GAP, column),
+                .y = area.y + span_offset(area.height, rows, GAP, row),
+                .width = span_length(area.width, in_row, GAP, column),
+                .height = span_length(area.height, rows, GAP, row),
+            });
+        }
+        placed += in_row;
+    }
+}
+
+// The oldest window takes about two thirds of the column grid; the others
+// stack in the remaining narrow column.
+void asymmetrical_tiles(const struct wlr_box &area, std::size_t count, std::vector<struct wlr_box> &tiles) {
+    if (count == 1) {
+        tiles.push_back(area);
+        return;
+    }
+
+    constexpr int pitch = SwissDesign::COLUMN_WIDTH + SwissDesign::GUTTER_WIDTH;
+    const int columns = (area.width + SwissDesign::GUTTER_WIDTH) / pitch;
+    int main_width = (area.width - SwissDesign::GUTTER_WIDTH) / 2;
+    if (columns >= 3) {
+        main_width = ((columns * 2 + 1) / 3) * pitch - SwissDesign::GUTTER_WIDTH;
+    }
+    tiles.push_back({.x = area.x, .y = area.y, .width = main_width, .height = area.height});
+
+    const int side_x = area.x + main_width + SwissDesign::GUTTER_WIDTH;
+    const int side_width = area.x + area.width - side_x;
+    const int stacked = static_cast<int>(count - 1);
+    for (int row = 0; row < stacked; ++row) {
+        tiles.push_back({
+            .x = side_x,
+            .y = area.y + span_offset(area.height, stacked, GAP, row),
+            .width = side_width,
+            .height = span_length(area.height, stacked, GAP, row),
+        });
+    }
+}
+
+TilingContainer *container_for(ArolloaServer *server, const ArolloaOutput *output) {
+    for (auto &container : server->tiling.containers) {
+        if (container.output == output) {
+            return &container;
+        }
+    }
+    return nullptr;
+}
+
+void ensure_containers(ArolloaServer *server) {
+    ArolloaOutput *output = nullptr;
+    wl_list_for_each(output, &server->outputs, link) {
+        if (!container_for(server, output)) {
+            TilingContainer container;
+            container.output = output;
+            container.area = output_usable_area(server, output);
+            container.dirty = true;
+            server->tiling.containers.push_back(std::move(container));
+        }
+    }
+}
+
+// New windows go to the output under the cursor.
+TilingContainer *container_at_cursor(ArolloaServer *server) {
+    ensure_containers(server);
+    ArolloaOutput *output = output_at_cursor(server);
+    return output ? container_for(server, output) : nullptr;
+}
+
+void set_tiled(ArolloaView *view, bool tiled) {
+    if (view->tiled == tiled || !view->xdg_surface->toplevel) {
+        return;
+    }
+    view->tiled = tiled;
+    // Tiled clients drop their own shadows and rounded corners.
+    const uint32_t edges = tiled ? ALL_EDGES : static_cast<uint32_t>(WLR_EDGE_NONE);
+    wlr_xdg_toplevel_set_tiled(view->xdg_surface->toplevel, edges);
+}
+
+// Sends the configure for the view's tile; the move itself is applied by
+// the layout transaction once the client has drawn the new size.
+void apply_tile(ArolloaServer *server, ArolloaView *view, const struct wlr_box &tile) {
+    const struct wlr_box box = view_box_for_frame(view, tile);
+    const int width = std::max(box.width, 1);
+    const int height = std::max(box.height, 1);
+
+    set_tiled(view, true);
+    uint32_t serial = 0;
+    if (width != view->configured_width || height != view->configured_height) {
+        view->configured_width = width;
+        view->configured_height = height;
+        serial = wlr_xdg_toplevel_set_size(view->xdg_surface->toplevel, width, height);
+    }
+    if (serial != 0 || view->x != box.x || view->y != box.y || view->awaiting_layout) {
+        transaction_add(server, view, {.x = box.x, .y = box.y, .width = width, .height = height}, serial);
+    }
+}
+
+void relayout(ArolloaServer *server, TilingContainer &container) {
+    container.dirty = false;
+    if (server->layout_mode == WindowLayout::FLOATING || wlr_box_empty(&container.area)) {
+        return;
+    }
+
+    auto &tiled = server->tiling.scratch_views;
+    auto &tiles = server->tiling.scratch_tiles;
+    tiled.clear();
+    tiles.clear();
+    for (ArolloaView *view : container.views) {
+        if (view->mapped && !view->floating && !view->hidden) {
+            tiled.push_back(view);
+        }
+    }
+    if (tiled.empty()) {
+        return;
+    }
+
+    if (server->layout_mode == WindowLayout::ASYMMETRICAL) {
+        asymmetrical_tiles(container.area, tiled.size(), tiles);
+    } else {
+        grid_tiles(container.area, tiled.size(), tiles);
+    }
+
+    // Fullscreen views keep their tile for when they come back.
+    for (std::size_t i = 0; i < tiled.size(); ++i) {
+        if (!tiled[i]->fullscreen) {
+            apply_tile(server, tiled[i], tiles[i]);
+        }
+    }
+}
+
+// Runs once per event loop iteration, so a burst of maps or a layout
+// switch relayouts each affected output once, wlroots sends all the
+// resulting configures together and a single transaction presents them.
+void flush_relayout(void *data) {
+    auto *server = static_cast<ArolloaServer *>(data);
+    server->tiling.flush = nullptr;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t containers = 0;
+    for (auto &container : server->tiling.containers) {
+        if (container.dirty) {
+            relayout(server, container);
+            ++containers;
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    wlr_log(WLR_DEBUG, "Relayout of %zu output(s) took %lld us", containers, static_cast<long long>(elapsed.count()));
+    transaction_commit(server);
+}
+
+void mark_dirty(ArolloaServer *server, TilingContainer &container) {
+    container.dirty = true;
+    if (!server->tiling.flush && server->wl_display) {
+        server->tiling.flush =
+            wl_event_loop_add_idle(wl_display_get_event_loop(server->wl_display), flush_relayout, server);
+    }
+}
+
+void adopt(ArolloaServer *server, TilingContainer &container, ArolloaView *view) {
+    view->output = container.output;
+    container.views.push_back(view);
+    mark_dirty(server, container);
+}
+} // namespace
+
+// Adds a newly mapped view to the container of the output under the cursor.
+// Returns true when tiling positions the view, false when it floats.
+bool tiling_view_mapped(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    view->floating = false;
+    view->configured_width = 0;
+    view->configured_height = 0;
+
+    TilingContainer *container = container_at_cursor(server);
+    if (!container) {
+        server->tiling.orphans.push_back(view);
+        return false;
+    }
+    adopt(server, *container, view);
+    if (server->layout_mode == WindowLayout::FLOATING || wlr_box_empty(&container->area)) {
+        return false;
+    }
+    // Hidden until its first layout lands, so it never flashes at a
+    // stale position or size.
+    view->awaiting_layout = true;
+    return true;
+}
+
+void tiling_view_unmapped(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    auto &orphans = server->tiling.orphans;
+    orphans.erase(std::remove(orphans.begin(), orphans.end(), view), orphans.end());
+
+    if (TilingContainer *container = view->output ? container_for(server, view->output) : nullptr) {
+        auto &views = container->views;
+        views.erase(std::remove(views.begin(), views.end(), view), views.end());
+        if (!view->floating) {
+            mark_dirty(server, *container);
+        }
+    }
+    view->output = nullptr;
+    view->tiled = false;
+}
+
+// Dragging a tiled window takes it out of the arrangement; the rest close
+// the gap.
+void tiling_float_view(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    if (server->layout_mode == WindowLayout::FLOATING || view->floating) {
+        return;
+    }
+
+    view->floating = true;
+    view->configured_width = 0;
+    view->configured_height = 0;
+    set_tiled(view, false);
+    if (TilingContainer *container = view->output ? container_for(server, view->output) : nullptr) {
+        mark_dirty(server, *container);
+    }
+}
+
+// A window that settled on another output joins that output's container
+// and its visible workspace, so workspace switches there hide and show it.
+void tiling_move_view(ArolloaView *view, ArolloaOutput *output) {
+    ArolloaServer *server = view->server;
+    if (!view->mapped || !output || view->output == output) {
+        return;
+    }
+
+    ensure_containers(server);
+    TilingContainer *target = container_for(server, output);
+    if (!target) {
+        return;
+    }
+    if (TilingContainer *source = view->output ? container_for(server, view->output) : nullptr) {
+        auto &views = source->views;
+        views.erase(std::remove(views.begin(), views.end(), view), views.end());
+        if (!view->floating) {
+            mark_dirty(server, *source);
+        }
+    } else {
+        auto &orphans = server->tiling.orphans;
+        orphans.erase(std::remove(orphans.begin(), orphans.end(), view), orphans.end());
+    }
+    adopt(server, *target, view);
+    view->workspace = output->active_workspace;
+    workspace_refresh_view(view);
+}
+
+// Switching layouts retiles every window, including floated ones.
+void tiling_set_mode(ArolloaServer *server, WindowLayout mode) {
+    if (!server) {
+        return;
+    }
+
+    server->layout_mode = mode;
+    for (auto &container : server->tiling.containers) {
+        for (ArolloaView *view : container.views) {
+            view->floating = false;
+            if (mode == WindowLayout::FLOATING) {
+                view->configured_width = 0;
+                view->configured_height = 0;
+                set_tiled(view, false);
+            }
+        }
+        mark_dirty(server, container);
+    }
+}
+
+// Only outputs whose usable area changed are relaid out.
+void tiling_outputs_changed(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    ensure_containers(server);
+    for (auto &container : server->tiling.containers) {
+        const struct wlr_box area = output_usable_area(server, container.output);
+        if (!wlr_box_equal(&area, &container.area)) {
+            container.area = area;
+            mark_dirty(server, container);
+        }
+    }
+
+    auto &orphans = server->tiling.orphans;
+    if (!orphans.empty() && !server->tiling.containers.empty()) {
+        TilingContainer &target = server->tiling.containers.front();
+        for (ArolloaView *view : orphans) {
+            adopt(server, target, view);
+        }
+        orphans.clear();
+    }
+}
+
+// Windows on a disconnected output move to the first remaining one.
+void tiling_forget_output(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server) {
+        return;
+    }
+
+    auto &containers = server->tiling.containers;
+    auto it = std::find_if(containers.begin(), containers.end(), [output](const TilingContainer &container) {
+        return container.output == output;
+    });
+    if (it == containers.end()) {
+        return;
+    }
+    std::vector<ArolloaView *> views = std::move(it->views);
+    containers.erase(it);
+
+    for (ArolloaView *view : views) {
+        if (!containers.empty()) {
+            adopt(server, containers.front(), view);
+            workspace_refresh_view(view);
+        } else {
+            view->output = nullptr;
+            server->tiling.orphans.push_back(view);
+        }
+    }
+}
+
+void tiling_mark_output_dirty(ArolloaServer *server, ArolloaOutput *output) {
+    if (!server) {
+        return;
+    }
+    if (TilingContainer *container = container_for(server, output)) {
+        mark_dirty(server, *container);
+    }
+}
+
+void tiling_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &tiling = server->tiling;
+    if (tiling.flush) {
+        wl_event_source_remove(tiling.flush);
+        tiling.flush = nullptr;
+    }
+    tiling.containers.clear();
+    tiling.orphans.clear();
+}
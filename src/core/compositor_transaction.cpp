@@ -0,0 +1,208 @@
+#include "../../include/arolloa.h"
+
+#include <ctime>
+
+namespace {
+// Clients that have not drawn their new size by then are shown as they are.
+constexpr int TRANSACTION_TIMEOUT_MS = 200;
+
+uint64_t monotonic_ns() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Serials wrap; anything at or after the pending one acknowledges it.
+bool serial_reached(uint32_t current, uint32_t pending) {
+    return static_cast<int32_t>(current - pending) >= 0;
+}
+
+LayoutTransaction::Instruction *find_instruction(LayoutTransaction &transaction, const ArolloaView *view) {
+    for (auto &instruction : transaction.instructions) {
+        if (instruction.view == view) {
+            return &instruction;
+        }
+    }
+    return nullptr;
+}
+
+// Keeps the buffer the view shows now, so it stays on screen unchanged
+// while the client draws its new size. A locked client buffer also keeps
+// wlroots from updating its texture in place.
+void save_buffer(ArolloaView *view) {
+    struct wlr_surface *surface = view->xdg_surface->surface;
+    if (view->saved_buffer || view->awaiting_layout || !surface->buffer) {
+        return;
+    }
+    struct wlr_texture *texture = wlr_surface_get_texture(surface);
+    if (!texture) {
+        return;
+    }
+    view->saved_texture = texture;
+    view->saved_buffer = wlr_buffer_lock(&surface->buffer->base);
+    render_list_update(view);
+}
+
+void drop_saved_buffer(ArolloaView *view) {
+    if (view->saved_buffer) {
+        wlr_buffer_unlock(view->saved_buffer);
+    }
+    view->saved_buffer = nullptr;
+    view->saved_texture = nullptr;
+}
+
+void apply(ArolloaServer *server, bool timed_out) {
+    auto &transaction = server->transaction;
+    if (transaction.timeout) {
+        wl_event_source_remove(transaction.timeout);
+        transaction.timeout = nullptr;
+    }
+    std::vector<LayoutTransaction::Instruction> instructions = std::move(transaction.instructions);
+    transaction.instructions.clear();
+    transaction.waiting = 0;
+
+    for (const auto &instruction : instructions) {
+        ArolloaView *view = instruction.view;
+        if (!view->awaiting_layout) {
+            mark_region_dirty(server, view_frame_box(view));
+        }
+        const struct wlr_surface *surface = view->xdg_surface->surface;
+        view->x = instruction.box.x;
+        view->y = instruction.box.y;
+        view->width = surface->current.width;
+        view->height = surface->current.height;
+        view->awaiting_layout = false;
+        drop_saved_buffer(view);
+        mark_region_dirty(server, view_frame_box(view));
+        view_index_update(server, view);
+        render_list_update(view);
+    }
+
+    const auto elapsed_ms = static_cast<long long>((monotonic_ns() - transaction.started_ns) / 1000000ull);
+    wlr_log(WLR_DEBUG, "Applied layout of %zu view(s) after %lld ms%s", instructions.size(), elapsed_ms,
+            timed_out ? " (timed out)" : "");
+    cursor_rebase(server);
+    mark_ui_dirty(server);
+    mark_content_dirty(server);
+}
+
+int handle_timeout(void *data) {
+    apply(static_cast<ArolloaServer *>(data), true);
+    return 0;
+}
+} // namespace
+
+// Queues a view's next position and, when its size changes, the configure
+// that must be acknowledged first. Views already in flight are updated in
+// place, so overlapping layout changes land together.
+void transaction_add(ArolloaServer *server, ArolloaView *view, const struct wlr_box &box, uint32_t serial) {
+    if (!server || !view) {
+        return;
+    }
+
+    auto &transaction = server->transaction;
+    if (transaction.instructions.empty()) {
+        transaction.started_ns = monotonic_ns();
+    }
+
+    LayoutTransaction::Instruction *instruction = find_instruction(transaction, view);
+    if (!instruction) {
+        transaction.instructions.push_back({.view = view, .box = box, .serial = 0, .ready = true});
+        instruction = &transaction.instructions.back();
+    }
+    instruction->box = box;
+    if (serial != 0) {
+        if (instruction->ready) {
+            ++transaction.waiting;
+        }
+        instruction->serial = serial;
+        instruction->ready = false;
+        save_buffer(view);
+    }
+}
+
+// Applies immediately when nothing needs a new buffer, otherwise waits for
+// the clients or the timeout, whichever comes first.
+void transaction_commit(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &transaction = server->transaction;
+    if (transaction.instructions.empty()) {
+        return;
+    }
+    if (transaction.waiting == 0) {
+        apply(server, false);
+        return;
+    }
+    if (!transaction.timeout && server->wl_display) {
+        transaction.timeout =
+            wl_event_loop_add_timer(wl_display_get_event_loop(server->wl_display), handle_timeout, server);
+        if (transaction.timeout) {
+            wl_event_source_timer_update(transaction.timeout, TRANSACTION_TIMEOUT_MS);
+        }
+    }
+}
+
+// Returns true when the commit belongs to a view whose new state is held
+// back, in which case the caller leaves the view untouched.
+bool transaction_handle_commit(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    auto &transaction = server->transaction;
+    LayoutTransaction::Instruction *instruction = find_instruction(transaction, view);
+    if (!instruction) {
+        return false;
+    }
+
+    if (!instruction->ready &&
+        serial_reached(view->xdg_surface->current.configure_serial, instruction->serial)) {
+        instruction->ready = true;
+        if (--transaction.waiting == 0) {
+            apply(server, false);
+        }
+    }
+    return true;
+}
+
+void transaction_forget_view(ArolloaView *view) {
+    ArolloaServer *server = view->server;
+    auto &transaction = server->transaction;
+    drop_saved_buffer(view);
+    view->awaiting_layout = false;
+
+    auto &instructions = transaction.instructions;
+    auto it = std::find_if(instructions.begin(), instructions.end(),
+        [view](const LayoutTransaction::Instruction &instruction) {
+            return instruction.view == view;
+        });
+    if (it == instructions.end()) {
+        return;
+    }
+    const bool was_waiting = !it->ready;
+    instructions.erase(it);
+    if (was_waiting && --transaction.waiting == 0 && !instructions.empty()) {
+        apply(server, false);
+    }
+    if (instructions.empty() && transaction.timeout) {
+        wl_event_source_remove(transaction.timeout);
+        transaction.timeout = nullptr;
+    }
+}
+
+void transaction_finish(ArolloaServer *server) {
+    if (!server) {
+        return;
+    }
+
+    auto &transaction = server->transaction;
+    if (transaction.timeout) {
+        wl_event_source_remove(transaction.timeout);
+        transaction.timeout = nullptr;
+    }
+    for (auto &instruction : transaction.instructions) {
+        drop_saved_buffer(instruction.view);
+    }
+    transaction.instructions.clear();
+    transaction.waiting = 0;
+}
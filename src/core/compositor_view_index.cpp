@@ -0,0 +1,198 @@
+#include "../../include/arolloa.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 256 px cells: a maximised window touches a few dozen cells, while a point
+// query only ever inspects the handful of views overlapping one cell.
+constexpr int CELL_SHIFT = 8;
+
+uint64_t cell_key(int cell_x, int cell_y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+}
+
+template <typename Fn>
+void for_each_cell(const struct wlr_box &box, Fn &&fn) {
+    const int first_x = box.x >> CELL_SHIFT;
+    const int first_y = box.y >> CELL_SHIFT;
+    const int last_x = (box.x + box.width - 1) >> CELL_SHIFT;
+    const int last_y = (box.y + box.height - 1) >> CELL_SHIFT;
+    for (int cell_y = first_y; cell_y <= last_y; ++cell_y) {
+        for (int cell_x = first_x; cell_x <= last_x; ++cell_x) {
+            fn(cell_key(cell_x, cell_y));
+        }
+    }
+}
+
+bool stacked_below(const ArolloaView *a, const ArolloaView *b) {
+    return a->stack_order < b->stack_order;
+}
+
+void insert_into_cells(ViewSpatialIndex &index, ArolloaView *view) {
+    for_each_cell(view->index_box, [&](uint64_t key) {
+        auto &bucket = index.cells[key];
+        bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), view, stacked_below), view);
+    });
+    view->indexed = true;
+}
+
+void remove_from_cells(ViewSpatialIndex &index, ArolloaView *view) {
+    for_each_cell(view->index_box, [&](uint64_t key) {
+        auto it = index.cells.find(key);
+        if (it == index.cells.end()) {
+            return;
+        }
+        auto &bucket = it->second;
+        bucket.erase(std::remove(bucket.begin(), bucket.end(), view), bucket.end());
+        if (bucket.empty()) {
+            index.cells.erase(it);
+        }
+    });
+    view->indexed = false;
+}
+} // namespace
+
+void view_index_update(ArolloaServer *server, ArolloaView *view) {
+    if (!server || !view) {
+        return;
+    }
+
+    const struct wlr_surface *surface = view->xdg_surface ? view->xdg_surface->surface : nullptr;
+    if (!view->mapped || view->hidden || view->awaiting_layout || !surface || surface->current.width <= 0 ||
+        surface->current.height <= 0) {
+        view_index_remove(server, view);
+        return;
+    }
+
+    // The frame is indexed too, so clicks on the titlebar find the view.
+    const struct wlr_box box = view_frame_box(view);
+    if (view->indexed && wlr_box_equal(&box, &view->index_box)) {
+        return;
+    }
+
+    if (view->indexed) {
+        remove_from_cells(server->view_index, view);
+    }
+    if (view->stack_order == 0) {
+        view->stack_order = server->view_index.next_stack_order++;
+    }
+    view->index_box = box;
+    insert_into_cells(server->view_index, view);
+}
+
+void view_index_remove(ArolloaServer *server, ArolloaView *view) {
+    if (!server || !view || !view->indexed) {
+        return;
+    }
+    remove_from_cells(server->view_index, view);
+}
+
+ArolloaView *view_at(ArolloaServer *server, double lx, double ly, struct wlr_surface **surface, double *sx, double *sy) {
+    if (!server) {
+        return nullptr;
+    }
+
+    const int px = static_cast<int>(std::floor(lx));
+    const int py = static_cast<int>(std::floor(ly));
+    auto it = server->view_index.cells.find(cell_key(px >> CELL_SHIFT, py >> CELL_SHIFT));
+    if (it == server->view_index.cells.end()) {
+        return nullptr;
+    }
+
+    // Topmost first; the surface lookup honours input regions and subsurfaces.
+    const auto &bucket = it->second;
+    for (auto candidate = bucket.rbegin(); candidate != bucket.rend(); ++candidate) {
+        ArolloaView *view = *candidate;
+        if (!wlr_box_contains_point(&view->index_box, lx, ly)) {
+            continue;
+        }
+
+        double local_x = 0.0;
+        double local_y = 0.0;
+        struct wlr_surface *hit = wlr_xdg_surface_surface_at(view->xdg_surface, lx - view->x, ly - view->y,
+                                                             &local_x, &local_y);
+        if (!hit) {
+            // Our titlebar covers whatever is stacked below it.
+            if (view_decoration_hit(view, lx, ly) != DecorationHit::NONE) {
+                return nullptr;
+            }
+            continue;
+        }
+
+        if (surface) {
+            *surface = hit;
+        }
+        if (sx) {
+            *sx = local_x;
+        }
+        if (sy) {
+            *sy = local_y;
+        }
+        return view;
+    }
+
+    return nullptr;
+}
+
+// The view whose server-side titlebar is the topmost thing under the point.
+ArolloaView *view_decoration_at(ArolloaServer *server, double lx, double ly, DecorationHit *hit) {
+    if (!server) {
+        return nullptr;
+    }
+
+    const int px = static_cast<int>(std::floor(lx));
+    const int py = static_cast<int>(std::floor(ly));
+    auto it = server->view_index.cells.find(cell_key(px >> CELL_SHIFT, py >> CELL_SHIFT));
+    if (it == server->view_index.cells.end()) {
+        return nullptr;
+    }
+
+    const auto &bucket = it->second;
+    for (auto candidate = bucket.rbegin(); candidate != bucket.rend(); ++candidate) {
+        ArolloaView *view = *candidate;
+        if (!wlr_box_contains_point(&view->index_box, lx, ly)) {
+            continue;
+        }
+        if (wlr_xdg_surface_surface_at(view->xdg_surface, lx - view->x, ly - view->y, nullptr, nullptr)) {
+            return nullptr;
+        }
+        const DecorationHit part = view_decoration_hit(view, lx, ly);
+        if (part != DecorationHit::NONE) {
+            if (hit) {
+                *hit = part;
+            }
+            return view;
+        }
+    }
+    return nullptr;
+}
+
+void raise_view(ArolloaServer *server, ArolloaView *view) {
+    if (!server || !view || server->views.prev == &view->link) {
+        return;
+    }
+
+    // The views list is kept in stacking order, bottom to top.
+    wl_list_remove(&view->link);
+    wl_list_insert(server->views.prev, &view->link);
+    render_list_raise(view);
+
+    const bool indexed = view->indexed;
+    if (indexed) {
+        remove_from_cells(server->view_index, view);
+    }
+    view->stack_order = server->view_index.next_stack_order++;
+    if (indexed) {
+        insert_into_cells(server->view_index, view);
+    }
+
+    // Only pixels inside the raised frame change, unless the overview shows
+    // windows in stacking order.
+    if (server->overview.visible) {
+        mark_ui_dirty(server);
+        mark_content_dirty(server);
+    } else if (view->mapped && !view->hidden) {
+        mark_region_dirty(server, view_frame_box(view));
+    }
+}
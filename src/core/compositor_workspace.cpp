@@ -0,0 +1,97 @@
+#include "../../include/arolloa.h"
+#include <wlr/version.h>
+
+namespace {
+constexpr uint32_t WORKSPACE_COUNT = 9;
+
+bool on_active_workspace(const ArolloaView *view) {
+    return view->workspace == (view->output ? view->output->active_workspace : 0);
+}
+
+// Hidden views drop out of hit-testing here and out of rendering, and with
+// it frame callbacks, in output_frame. Clients that understand it are also
+// told they are suspended.
+void set_hidden(ArolloaServer *server, ArolloaView *view, bool hidden) {
+    if (view->hidden == hidden) {
+        return;
+    }
+
+    if (hidden) {
+        mark_region_dirty(server, view_frame_box(view));
+        view->hidden = true;
+        view_index_remove(server, view);
+        render_list_update(view);
+    } else {
+        view->hidden = false;
+        view_index_update(server, view);
+        render_list_update(view);
+        mark_region_dirty(server, view_frame_box(view));
+    }
+#if defined(WLR_VERSION_NUM) && WLR_VERSION_NUM >= ((0 << 16) | (18 << 8) | 0)
+    if (view->xdg_surface->toplevel) {
+        wlr_xdg_toplevel_set_suspended(view->xdg_surface->toplevel, hidden);
+    }
+#endif
+}
+
+void refocus(ArolloaServer *server) {
+    ArolloaView *focused = server->focused_view;
+    if (!focused || !focused->hidden) {
+        return;
+    }
+    if (focused->xdg_surface->toplevel) {
+        wlr_xdg_toplevel_set_activated(focused->xdg_surface->toplevel, false);
+    }
+    focus_top_view(server);
+}
+
+void finish_change(ArolloaServer *server) {
+    refocus(server);
+    cursor_rebase(server);
+    mark_ui_dirty(server);
+}
+} // namespace
+
+// New windows open on the active workspace of their output.
+void workspace_view_mapped(ArolloaView *view) {
+    view->workspace = view->output ? view->output->active_workspace : 0;
+    view->hidden = false;
+}
+
+// Re-evaluates visibility after a view changed output.
+void workspace_refresh_view(ArolloaView *view) {
+    if (!view->mapped) {
+        return;
+    }
+    set_hidden(view->server, view, !on_active_workspace(view));
+    refocus(view->server);
+}
+
+// Only views on this output change state; those staying hidden cost a
+// flag check, and tiling lays out just the workspace that became visible.
+void workspace_switch(ArolloaServer *server, ArolloaOutput *output, uint32_t workspace) {
+    if (!server || !output || workspace >= WORKSPACE_COUNT || output->active_workspace == workspace) {
+        return;
+    }
+
+    output->active_workspace = workspace;
+    ArolloaView *view = nullptr;
+    wl_list_for_each(view, &server->views, link) {
+        if (view->mapped && view->output == output) {
+            set_hidden(server, view, view->workspace != workspace);
+        }
+    }
+    tiling_mark_output_dirty(server, output);
+    finish_change(server);
+}
+
+void workspace_move_view(ArolloaServer *server, ArolloaView *view, uint32_t workspace) {
+    if (!server || !view || !view->mapped || workspace >= WORKSPACE_COUNT || view->workspace == workspace) {
+        return;
+    }
+
+    view->workspace = workspace;
+    set_hidden(server, view, !on_active_workspace(view));
+    tiling_mark_output_dirty(server, view->output);
+    finish_change(server);
+}
@@ -32,12 +32,20 @@ void load_swiss_config() {
         config["appearance.corner_radius"] = std::to_string(SwissDesign::CORNER_RADIUS);
         config["animation.enabled"] = "true";
         config["animation.duration"] = std::to_string(SwissDesign::ANIMATION_DURATION);
+        config["animation.low_power_fps"] = "20";
+        config["power.low_power"] = "auto";
         config["colors.background"] = "#ffffff";
         config["colors.foreground"] = "#000000";
         config["colors.accent"] = "#cc0000";
         config["colors.panel"] = "#ffffff";
         config["colors.panel_text"] = "#202020";
+        config["decorations.server_side"] = "true";
         config["notifications.enabled"] = "true";
+        config["thumbnails.budget_mb"] = "32";
+        config["launcher.terminal"] = "foot";
+        config["performance.adaptive_quality"] = "true";
+        config["debug.latency_trace"] = "false";
+        config["debug.launch_timing"] = "false";
 
         save_swiss_config();
     }
@@ -75,6 +83,17 @@ int get_config_int(const std::string& key, int default_value) {
     return default_value;
 }
 
+std::vector<std::pair<std::string, std::string>> get_config_entries(const std::string& prefix) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (auto it = config.lower_bound(prefix); it != config.end(); ++it) {
+        if (it->first.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        entries.emplace_back(it->first.substr(prefix.size()), it->second);
+    }
+    return entries;
+}
+
 bool get_config_bool(const std::string& key, bool default_value) {
     auto it = config.find(key);
     if (it != config.end()) {